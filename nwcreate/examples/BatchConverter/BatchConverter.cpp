@@ -0,0 +1,331 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include <nwcreate/LiNwcAll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "BudgetedScene.h"
+#include "ColumnGeometry.h"
+#include "ColumnSpec.h"
+#include "ConversionManifest.h"
+#include "GeometryRecorder.h"
+#include "GuidBatch.h"
+#include "ProcessPool.h"
+
+// Only circle columns are converted
+ColumnProfile ColumnSpec::m_profile = eCIRCLE;
+
+// Options that affect the output. Change converter_version whenever the
+// conversion code changes what is written, so every cache is remade.
+static const char* const cOPTION_NAMES[] =
+{
+   "converter_version",
+   "faceting_factor",
+   "memory_budget",
+   "recenter_geometry"
+};
+static const LtInt32 cCONVERTER_VERSION = 2;
+
+typedef std::chrono::steady_clock Clock;
+
+static void
+define_options(LcNwcOptionSet& options)
+{
+   LcNwcData value;
+
+   value.SetInt32(cCONVERTER_VERSION);
+   options.DefineOption("converter_version", value);
+
+   value.SetFloat(1.0);
+   options.DefineOption("faceting_factor", value);
+
+   value.SetBoolean(true);
+   options.DefineOption("recenter_geometry", value);
+
+   // Megabytes, zero for no limit
+   value.SetInt32(0);
+   options.DefineOption("memory_budget", value);
+}
+
+static void
+record_column(GeometryRecorder& recorder, ColumnSpec& spec, LtFloat faceting_factor)
+{
+   LtPoint base;
+   spec.GetCenter(base);
+
+   recorder.FacetingFactor(faceting_factor);
+   recorder.Begin(LI_NWC_VERTEX_NORMAL);
+   stream_circle_column(recorder, base, spec.GetHeight());
+   recorder.End();
+}
+
+// Child process: converts one file, spilling to part files if the scene
+// grows past budget_mb
+static int
+convert_file(LtWideString input, LtWideString output, LtFloat faceting_factor, bool recenter,
+             LtInt32 budget_mb)
+{
+   std::vector<ColumnSpec> columns;
+   if (ColumnSpec::LoadFromFile(input, columns) != LI_NWC_LOAD_OK)
+      return 1;
+
+   BudgetedScene scene(input, output, size_t(budget_mb) * 1024 * 1024);
+   GeometryRecorder recorder;
+   GuidBatch guids;
+   for (size_t i = 0; i < columns.size(); i++)
+   {
+      recorder.Clear();
+      record_column(recorder, columns[i], faceting_factor);
+
+      LcNwcGeometry geom;
+      LcNwcGeometryStream stream = geom.OpenStream();
+      if (recenter)
+         recorder.ReplayRecentered(stream);
+      else
+         recorder.Replay(stream);
+      geom.CloseStream(stream);
+
+      geom.SetGuid(guids.AddGuidString(columns[i].GetGuid().c_str()));
+      if (!scene.AddNode(geom, BudgetedScene::EstimateGeometry(recorder)))
+         return 1;
+   }
+
+   return (scene.Write() == LI_NWC_WRITE_OK) ? 0 : 1;
+}
+
+// Cache pathname for input, in output_dir. Inputs with the same name in
+// different directories are told apart by a hash of the full input path.
+static std::wstring
+output_pathname(const std::wstring& output_dir, LtWideString input)
+{
+   wchar_t full_path[_MAX_PATH];
+   if (!_wfullpath(full_path, input, _MAX_PATH))
+      wcscpy_s(full_path, input);
+
+   // FNV-1a, case blind as Windows paths are
+   LtNat64 hash = 14695981039346656037ULL;
+   for (const wchar_t* p = full_path; *p; p++)
+   {
+      hash ^= LtNat64(towlower(*p));
+      hash *= 1099511628211ULL;
+   }
+
+   wchar_t name[_MAX_FNAME];
+   _wsplitpath_s(full_path, NULL, 0, NULL, 0, name, _MAX_FNAME, NULL, 0);
+
+   wchar_t suffix[32];
+   swprintf_s(suffix, L"_%08x.nwc", LtNat32(hash ^ (hash >> 32)));
+   return output_dir + L"\\" + name + suffix;
+}
+
+// Input waiting for conversion
+struct Pending
+{
+   std::wstring input;
+   std::wstring output;
+   LtNat64 content_hash;
+   LtInt32 job;
+};
+
+// Parent process: converts stale inputs in parallel and updates manifest
+static int
+convert_batch(const LcNwcOptionSet& options, const std::wstring& output_dir,
+              int num_inputs, wchar_t* inputs[])
+{
+   Clock::time_point start = Clock::now();
+
+   LtNat64 options_hash = ConversionManifest::HashOptions(
+      options, cOPTION_NAMES, sizeof(cOPTION_NAMES) / sizeof(cOPTION_NAMES[0]));
+
+   LcNwcData value;
+   options.GetOption("faceting_factor", value);
+   LtFloat faceting_factor = value.GetFloat();
+   options.GetOption("recenter_geometry", value);
+   bool recenter = value.GetBoolean();
+   options.GetOption("memory_budget", value);
+   LtInt32 budget_mb = value.GetInt32();
+
+   std::wstring manifest_pathname = output_dir + L"\\manifest.txt";
+   ConversionManifest manifest;
+   manifest.Read(manifest_pathname.c_str());
+
+   ProcessPool processes;
+   std::vector<Pending> pending;
+   LtInt32 num_converted = 0, num_unchanged = 0, num_failed = 0;
+
+   for (int i = 0; i < num_inputs; i++)
+   {
+      Clock::time_point hash_start = Clock::now();
+
+      Pending file;
+      file.input = inputs[i];
+      file.output = output_pathname(output_dir, inputs[i]);
+      if (!ConversionManifest::HashFile(inputs[i], file.content_hash))
+      {
+         wprintf(L"%ls: can't read\n", inputs[i]);
+         manifest.Remove(file.input);
+         num_failed++;
+         continue;
+      }
+
+      LtFloat hash_ms = std::chrono::duration<LtFloat, std::milli>(Clock::now() - hash_start).count();
+
+      if (manifest.IsCurrent(file.input, file.output, file.content_hash, options_hash))
+      {
+         wprintf(L"%ls: unchanged (checked in %.0f ms)\n", inputs[i], hash_ms);
+         num_unchanged++;
+         continue;
+      }
+
+      wchar_t arguments[64];
+      swprintf_s(arguments, L"-convert %.17g %d %d ", faceting_factor, recenter ? 1 : 0, budget_mb);
+      file.job = processes.Add(arguments + (L"\"" + file.input + L"\" \"" + file.output + L"\""));
+      pending.push_back(file);
+   }
+
+   processes.Run();
+
+   for (size_t i = 0; i < pending.size(); i++)
+   {
+      const Pending& file = pending[i];
+      if (processes.GetExitCode(file.job) == 0)
+      {
+         wprintf(L"%ls: converted in %.0f ms\n", file.input.c_str(),
+                 processes.GetSeconds(file.job) * 1000);
+         manifest.Set(file.input, file.output, file.content_hash, options_hash);
+         num_converted++;
+      }
+      else
+      {
+         wprintf(L"%ls: failed\n", file.input.c_str());
+         manifest.Remove(file.input);
+         num_failed++;
+      }
+   }
+
+   if (!manifest.Write(manifest_pathname.c_str()))
+      wprintf(L"Can't write %ls\n", manifest_pathname.c_str());
+
+   LtFloat total_ms = std::chrono::duration<LtFloat, std::milli>(Clock::now() - start).count();
+   printf("%d converted, %d unchanged, %d failed in %.0f ms\n",
+          num_converted, num_unchanged, num_failed, total_ms);
+
+   return num_failed ? 1 : 0;
+}
+
+void LI_NWC_API
+error_handler(LtNwcSeverity severity, LtString message, void* user_data)
+{
+   switch (severity)
+   {
+   case LI_NWC_SEVERITY_ERROR:
+      printf("Error: %s\n", message);
+      exit(1);
+      break;
+
+   case LI_NWC_SEVERITY_WARNING:
+      printf("Warning: %s\n", message);
+      break;
+
+   default:
+      printf("UNKNOWN: %s\n", message);
+      exit(1);
+      break;
+   }
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+   bool child = argc == 7 && !wcscmp(argv[1], L"-convert");
+
+   LiNwcApiErrorInitialise();
+
+   switch (LiNwcApiInitialise())
+   {
+   case LI_NWC_API_OK:
+      break;
+
+   case LI_NWC_API_NOT_LICENSED:
+      printf("Not Licensed\n");
+      return 1;
+
+   case LI_NWC_API_INTERNAL_ERROR:
+   default:
+      printf("Internal Error\n");
+      return 1;
+   }
+
+   LiNwcApiSetErrorHandler(&error_handler, NULL);
+
+   int result = 1;
+   if (child)
+   {
+      result = convert_file(argv[5], argv[6], _wtof(argv[2]), _wtoi(argv[3]) != 0, _wtoi(argv[4]));
+   }
+   else
+   {
+      LcNwcOptionSet options;
+      define_options(options);
+
+      // Options, then output directory and inputs
+      int arg = 1;
+      bool bad_option = false;
+      LcNwcData value;
+      for (; arg < argc && argv[arg][0] == L'-' && !bad_option; arg++)
+      {
+         if (!wcscmp(argv[arg], L"-faceting_factor") && arg + 1 < argc)
+         {
+            value.SetFloat(_wtof(argv[++arg]));
+            options.SetOption("faceting_factor", value);
+         }
+         else if (!wcscmp(argv[arg], L"-norecenter"))
+         {
+            value.SetBoolean(false);
+            options.SetOption("recenter_geometry", value);
+         }
+         else if (!wcscmp(argv[arg], L"-memory_budget") && arg + 1 < argc)
+         {
+            value.SetInt32(_wtoi(argv[++arg]));
+            options.SetOption("memory_budget", value);
+         }
+         else
+         {
+            wprintf(L"Unknown option %ls\n", argv[arg]);
+            bad_option = true;
+         }
+      }
+
+      if (bad_option || argc - arg < 2)
+         printf("Usage: BatchConverter [-faceting_factor f] [-norecenter] [-memory_budget MB] output_dir input.mlf ...\n");
+      else
+         result = convert_batch(options, argv[arg], argc - arg - 1, argv + arg + 1);
+   }
+
+   LiNwcApiTerminate();
+
+   return result;
+}
@@ -0,0 +1,213 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include <nwcreate/LiNwcAll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ColumnSpec.h"
+
+// Not used, ColumnSpec needs a definition
+ColumnProfile ColumnSpec::m_profile = eCIRCLE;
+
+typedef std::chrono::steady_clock Clock;
+
+// The stream parser ColumnSpec::LoadFromFile used to have, for comparison
+static LtNwcLoadStatus
+load_stream(LtWideString pathname, std::vector<ColumnSpec>& columns)
+{
+   std::wstring height_str;
+   std::wstring x_str;
+   std::wstring y_str;
+   std::wstring z_str;
+   std::wstring guid;
+
+   std::wifstream file(pathname);
+
+   if (!file.is_open())
+      return LI_NWC_LOAD_CANT_OPEN;
+
+   while (file.good())
+   {
+      std::getline(file, height_str, L',');
+      std::getline(file, x_str, L',');
+      std::getline(file, y_str, L',');
+      std::getline(file, z_str, L',');
+      std::getline(file, guid);
+
+      LtFloat height = wcstod(height_str.c_str(), NULL);
+
+      LtPoint base = {
+         wcstod(x_str.c_str(), NULL),
+         wcstod(y_str.c_str(), NULL),
+         wcstod(z_str.c_str(), NULL) };
+
+      columns.push_back(ColumnSpec(height, base, guid));
+   }
+
+   return LI_NWC_LOAD_OK;
+}
+
+// Site plan of num_rows columns in georeferenced coordinates
+static bool
+write_synthetic(LtWideString pathname, LtInt32 num_rows)
+{
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"w");
+   if (!fp)
+      return false;
+
+   srand(1);
+   for (LtInt32 i = 0; i < num_rows; i++)
+   {
+      fprintf(fp, "%d,%.3f,%.3f,%.2f,%08X-%04X-4%03X-B267-7174BFA6C9D5\n",
+              3 + rand() % 40, 512000 + rand() % 100000 / 10.0, 4200000 + rand() % 100000 / 10.0,
+              rand() % 400 / 4.0, i, rand() & 0xffff, rand() & 0xfff);
+   }
+
+   fclose(fp);
+   return true;
+}
+
+static LtInt64
+file_size(LtWideString pathname)
+{
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"rb");
+   if (!fp)
+      return -1;
+
+   _fseeki64(fp, 0, SEEK_END);
+   LtInt64 size = _ftelli64(fp);
+   fclose(fp);
+
+   return size;
+}
+
+static void
+report(const char* parser, LtFloat seconds, size_t num_rows, LtInt64 size)
+{
+   printf("%-16s %10.1f %10.1f %12d\n", parser, seconds * 1000,
+          size / (1024.0 * 1024.0) / seconds, LtInt32(num_rows));
+}
+
+// Best of a few runs, to leave out the first read of the file
+static const int cNUM_RUNS = 3;
+
+static int
+do_bench(LtWideString pathname)
+{
+   LtInt64 size = file_size(pathname);
+   if (size < 0)
+   {
+      wprintf(L"Can't read %ls\n", pathname);
+      return 1;
+   }
+
+   printf("%-16s %10s %10s %12s\n", "parser", "ms", "MB/s", "rows");
+
+   std::vector<ColumnSpec> reference;
+   LtFloat best = 1e30;
+   for (int run = 0; run < cNUM_RUNS; run++)
+   {
+      reference.clear();
+      Clock::time_point start = Clock::now();
+      load_stream(pathname, reference);
+      best = std::min(best, std::chrono::duration<LtFloat>(Clock::now() - start).count());
+   }
+   report("stream", best, reference.size(), size);
+
+   std::vector<ColumnSpec> columns;
+   best = 1e30;
+   for (int run = 0; run < cNUM_RUNS; run++)
+   {
+      columns.clear();
+      Clock::time_point start = Clock::now();
+      ColumnSpec::LoadFromFile(pathname, columns);
+      best = std::min(best, std::chrono::duration<LtFloat>(Clock::now() - start).count());
+   }
+   report("ColumnSpec", best, columns.size(), size);
+
+   ColumnTable table;
+   const LtInt32 thread_counts[] = { 1, 0 };
+   for (int t = 0; t < 2; t++)
+   {
+      best = 1e30;
+      for (int run = 0; run < cNUM_RUNS; run++)
+      {
+         table.Clear();
+         Clock::time_point start = Clock::now();
+         ColumnTable::LoadFromFile(pathname, table, thread_counts[t]);
+         best = std::min(best, std::chrono::duration<LtFloat>(Clock::now() - start).count());
+      }
+      report(thread_counts[t] ? "ColumnTable x1" : "ColumnTable", best, table.GetSize(), size);
+   }
+
+   // The stream parser makes an extra empty column from a final line end
+   size_t num_rows = std::min(reference.size(), table.GetSize());
+   LtInt32 num_different = 0;
+   for (size_t i = 0; i < num_rows; i++)
+   {
+      LtPoint a, b;
+      reference[i].GetCenter(a);
+      table.GetCenter(i, b);
+      if (reference[i].GetHeight() != table.GetHeight(i) ||
+          a[0] != b[0] || a[1] != b[1] || a[2] != b[2] ||
+          reference[i].GetGuid() != table.GetGuid(i))
+         num_different++;
+   }
+   printf("%d of %d rows differ from stream parser\n", num_different, LtInt32(num_rows));
+
+   return num_different ? 1 : 0;
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+   if (argc > 2)
+   {
+      printf("Usage: ColumnBench [input.mlf | num_rows]\n");
+      return 1;
+   }
+
+   // A file, or the number of rows of a synthetic file
+   if (argc == 2 && !iswdigit(argv[1][0]))
+      return do_bench(argv[1]);
+
+   LtInt32 num_rows = (argc == 2) ? _wtoi(argv[1]) : 1000000;
+   LtWideString pathname = L"columnbench.mlf";
+   if (!write_synthetic(pathname, num_rows))
+   {
+      printf("Can't write synthetic file\n");
+      return 1;
+   }
+
+   int result = do_bench(pathname);
+   _wremove(pathname);
+
+   return result;
+}
@@ -0,0 +1,171 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include <nwcreate/LiNwcAll.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ColumnBinary.h"
+#include "ColumnSpec.h"
+
+// Not used, ColumnSpec needs a definition
+ColumnProfile ColumnSpec::m_profile = eCIRCLE;
+
+typedef std::chrono::steady_clock Clock;
+
+static LtFloat
+milliseconds_since(Clock::time_point start)
+{
+   return std::chrono::duration<LtFloat, std::milli>(Clock::now() - start).count();
+}
+
+// Compares bits, so NaNs read back from the companion match
+static bool
+same(LtFloat a, LtFloat b)
+{
+   return memcmp(&a, &b, sizeof(LtFloat)) == 0;
+}
+
+// Raw GUID written back as 8-4-4-4-12 text. Works from the bytes alone, so
+// it checks the parse that made them rather than repeating it.
+static void
+format_guid(const LtNat8 raw[16], wchar_t text[37])
+{
+   LtNat32 data1;
+   LtNat16 data2, data3;
+   memcpy(&data1, raw, 4);
+   memcpy(&data2, raw + 4, 2);
+   memcpy(&data3, raw + 6, 2);
+   swprintf(text, 37, L"%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+            data1, data2, data3, raw[8], raw[9], raw[10], raw[11], raw[12], raw[13], raw[14], raw[15]);
+}
+
+// True if text spells the same GUID as formatted, in either case, with or
+// without braces
+static bool
+same_guid(LtWideString text, const wchar_t* formatted)
+{
+   bool braces = (*text == L'{');
+   if (braces)
+      text++;
+
+   size_t i = 0;
+   for (; formatted[i]; i++)
+   {
+      if (wchar_t(towlower(text[i])) != formatted[i])
+         return false;
+   }
+
+   return braces ? (text[i] == L'}' && !text[i + 1]) : !text[i];
+}
+
+// Reads the companion back and checks every value against the text
+static LtInt32
+verify(LtWideString source, LtWideString pathname, const ColumnTable& table)
+{
+   ColumnBinary binary;
+   if (!binary.Open(pathname, source) || binary.GetSize() != table.GetSize())
+      return -1;
+
+   LtInt32 num_different = 0;
+   for (size_t i = 0; i < table.GetSize(); i++)
+   {
+      LtPoint center;
+      table.GetCenter(i, center);
+
+      wchar_t guid[37];
+      format_guid(binary.GetGuid(i), guid);
+
+      if (!same(binary.GetHeights()[i], table.GetHeight(i)) ||
+          !same(binary.GetX()[i], center[0]) ||
+          !same(binary.GetY()[i], center[1]) ||
+          !same(binary.GetZ()[i], center[2]) ||
+          !same_guid(table.GetGuid(i), guid))
+         num_different++;
+   }
+
+   return num_different;
+}
+
+static int
+pack(LtWideString source)
+{
+   ColumnTable table;
+   if (ColumnTable::LoadFromFile(source, table) != LI_NWC_LOAD_OK)
+   {
+      wprintf(L"Can't read %ls\n", source);
+      return 1;
+   }
+
+   std::wstring pathname = ColumnBinary::GetCompanionPathname(source);
+   if (!ColumnBinary::Write(pathname.c_str(), source, table))
+   {
+      wprintf(L"Can't write %ls, or a GUID isn't in 8-4-4-4-12 form\n", pathname.c_str());
+      return 1;
+   }
+
+   LtInt32 num_different = verify(source, pathname.c_str(), table);
+   if (num_different != 0)
+   {
+      wprintf(L"%ls doesn't read back: %d rows differ\n", pathname.c_str(), num_different);
+      return 1;
+   }
+
+   // What a loader sees: a table parsed from the text, and one mapped from
+   // the companion
+   ColumnTable columns;
+   Clock::time_point start = Clock::now();
+   ColumnTable::LoadFromFile(source, columns);
+   LtFloat text_ms = milliseconds_since(start);
+
+   columns.Clear();
+   start = Clock::now();
+   ColumnBinary::LoadFromFile(source, columns);
+   LtFloat binary_ms = milliseconds_since(start);
+
+   wprintf(L"%ls: %d rows, text %.1f ms, binary %.1f ms\n", pathname.c_str(),
+           LtInt32(table.GetSize()), text_ms, binary_ms);
+
+   return 0;
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+   if (argc < 2)
+   {
+      printf("Usage: ColumnPacker input.mlf...\n");
+      return 1;
+   }
+
+   int result = 0;
+   for (int i = 1; i < argc; i++)
+   {
+      if (pack(argv[i]) != 0)
+         result = 1;
+   }
+
+   return result;
+}
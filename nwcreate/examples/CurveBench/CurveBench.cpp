@@ -0,0 +1,306 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include <nwcreate/LiNwcAll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <wchar.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "CurveFlattener.h"
+
+#define         LI_PI                   3.14159265358979323846
+
+typedef std::chrono::steady_clock Clock;
+
+enum SymbolType { eDOOR, eBOLT, eCOLUMN, eOPENING, eSCROLL, eNUM_SYMBOL_TYPES };
+
+// One symbol of the synthetic drawing
+struct Symbol
+{
+   SymbolType type;
+   LtPoint2d position;
+   LtFloat rotation;
+   LtFloat scale;
+};
+
+// Cubic run of the scroll symbol, before scaling and placing
+static const LtPoint2d cSCROLL[7] = {
+   { 0, 0 }, { 0.4, 0.6 }, { 0.8, 0.6 }, { 1, 0 },
+   { 1.2, -0.6 }, { 1.6, -0.6 }, { 2, 0 } };
+
+// Floor plan of num_symbols symbols on a site. Symbols come in a few sizes
+// and right angle rotations, as they do in drawings.
+static void
+make_drawing(LtInt32 num_symbols, std::vector<Symbol>& symbols)
+{
+   static const LtFloat scales[] = { 0.5, 1, 2 };
+
+   srand(1);
+   symbols.resize(num_symbols);
+   for (LtInt32 i = 0; i < num_symbols; i++)
+   {
+      Symbol& symbol = symbols[i];
+      symbol.type = SymbolType(rand() % eNUM_SYMBOL_TYPES);
+      symbol.position[0] = rand() % 100000 / 10.0;
+      symbol.position[1] = rand() % 100000 / 10.0;
+      symbol.rotation = (rand() % 4) * LI_PI / 2;
+      symbol.scale = scales[rand() % 3];
+   }
+}
+
+// Parameters of the arc drawn by an arc based symbol
+struct SymbolArc
+{
+   LtFloat major_radius;
+   LtFloat minor_radius;
+   LtFloat start;
+   LtFloat end;
+   LtNwcPlotArcSweepDirection direction;
+};
+
+static SymbolArc
+symbol_arc(const Symbol& symbol)
+{
+   SymbolArc arc = { symbol.scale, symbol.scale, 0, 2 * LI_PI, LI_NWC_PLOT_ARC_SWEEP_COUNTERCLOCKWISE };
+   if (symbol.type == eDOOR)
+   {
+      // Doors hinged on the other side swing the other way
+      arc.major_radius = arc.minor_radius = 0.9 * symbol.scale;
+      arc.end = LI_PI / 2;
+      if (symbol.rotation >= LI_PI)
+      {
+         arc.start = LI_PI / 2;
+         arc.end = 0;
+         arc.direction = LI_NWC_PLOT_ARC_SWEEP_CLOCKWISE;
+      }
+   }
+   else if (symbol.type == eBOLT)
+   {
+      arc.major_radius = arc.minor_radius = 0.012 * symbol.scale;
+   }
+   else if (symbol.type == eOPENING)
+   {
+      arc.major_radius = 0.6 * symbol.scale;
+      arc.minor_radius = 0.3 * symbol.scale;
+   }
+   return arc;
+}
+
+// Control points of the scroll symbol, placed
+static void
+scroll_points(const Symbol& symbol, LtPoint2d points[7])
+{
+   LtFloat c = cos(symbol.rotation), s = sin(symbol.rotation);
+   for (int i = 0; i < 7; i++)
+   {
+      LtFloat x = cSCROLL[i][0] * symbol.scale, y = cSCROLL[i][1] * symbol.scale;
+      points[i][0] = symbol.position[0] + c * x - s * y;
+      points[i][1] = symbol.position[1] + s * x + c * y;
+   }
+}
+
+static void
+flatten(CurveFlattener& flattener, const Symbol& symbol, std::vector<LtFloat>& points)
+{
+   if (symbol.type == eSCROLL)
+   {
+      LtPoint2d control_points[7];
+      scroll_points(symbol, control_points);
+      flattener.PolyBezier(control_points, 7, points);
+      return;
+   }
+
+   SymbolArc arc = symbol_arc(symbol);
+   if (symbol.type == eDOOR)
+      flattener.Arc(symbol.position, arc.major_radius, arc.minor_radius, arc.start, arc.end,
+                    arc.direction, symbol.rotation, points);
+   else if (symbol.type == eOPENING)
+      flattener.Ellipse(symbol.position, arc.major_radius, arc.minor_radius, symbol.rotation, points);
+   else
+      flattener.Circle(symbol.position, arc.major_radius, points);
+}
+
+// Largest distance from the middle of a chord to the curve at the middle
+// of its parameter range, for the arc of symbol
+static LtFloat
+arc_deviation(const Symbol& symbol, const std::vector<LtFloat>& points)
+{
+   SymbolArc arc = symbol_arc(symbol);
+   LtFloat sweep = arc.end - arc.start;
+   LtFloat rotation = (symbol.type == eBOLT || symbol.type == eCOLUMN) ? 0 : symbol.rotation;
+   LtFloat cr = cos(rotation), sr = sin(rotation);
+
+   LtInt32 segments = LtInt32(points.size() / 2) - 1;
+   LtFloat deviation = 0;
+   for (LtInt32 i = 0; i <= segments; i++)
+   {
+      // End points lie on the curve, chord middles within tolerance of it
+      LtFloat t = (i < segments) ? i + 0.5 : i;
+      LtFloat a = arc.start + sweep * t / segments;
+      LtFloat x = arc.major_radius * cos(a), y = arc.minor_radius * sin(a);
+      LtFloat cx = symbol.position[0] + cr * x - sr * y;
+      LtFloat cy = symbol.position[1] + sr * x + cr * y;
+
+      LtFloat px = points[i * 2], py = points[i * 2 + 1];
+      if (i < segments)
+      {
+         px = (px + points[i * 2 + 2]) / 2;
+         py = (py + points[i * 2 + 3]) / 2;
+      }
+      deviation = std::max(deviation, sqrt((px - cx) * (px - cx) + (py - cy) * (py - cy)));
+   }
+   return deviation;
+}
+
+// As arc_deviation, for one cubic of the scroll at a time
+static LtFloat
+bezier_deviation(CurveFlattener& flattener, const Symbol& symbol)
+{
+   LtPoint2d control_points[7];
+   scroll_points(symbol, control_points);
+
+   LtFloat deviation = 0;
+   std::vector<LtFloat> points;
+   for (int c = 0; c < 2; c++)
+   {
+      const LtPoint2d* p = control_points + c * 3;
+      points.clear();
+      flattener.PolyBezier(p, 4, points);
+
+      LtInt32 segments = LtInt32(points.size() / 2) - 1;
+      for (LtInt32 i = 0; i < segments; i++)
+      {
+         LtFloat t = (i + 0.5) / segments, u = 1 - t;
+         LtFloat w[4] = { u * u * u, 3 * u * u * t, 3 * u * t * t, t * t * t };
+         LtFloat cx = 0, cy = 0;
+         for (int k = 0; k < 4; k++)
+         {
+            cx += w[k] * p[k][0];
+            cy += w[k] * p[k][1];
+         }
+
+         LtFloat px = (points[i * 2] + points[i * 2 + 2]) / 2;
+         LtFloat py = (points[i * 2 + 1] + points[i * 2 + 3]) / 2;
+         deviation = std::max(deviation, sqrt((px - cx) * (px - cx) + (py - cy) * (py - cy)));
+      }
+   }
+   return deviation;
+}
+
+static void
+report(const char* mode, LtFloat seconds, size_t num_points, LtInt32 num_flattened)
+{
+   printf("%-16s %10.1f %12d %12d\n", mode, seconds * 1000, LtInt32(num_points / 2), num_flattened);
+}
+
+// Best of a few runs
+static const int cNUM_RUNS = 3;
+
+static int
+do_bench(LtInt32 num_symbols, LtFloat tolerance)
+{
+   std::vector<Symbol> symbols;
+   make_drawing(num_symbols, symbols);
+
+   printf("%-16s %10s %12s %12s\n", "flattening", "ms", "points", "flattened");
+
+   // Templates kept from symbol to symbol, as in a loader
+   CurveFlattener flattener(tolerance);
+   std::vector<LtFloat> points;
+   LtFloat best = 1e30;
+   for (int run = 0; run < cNUM_RUNS; run++)
+   {
+      flattener.Clear();
+      points.clear();
+      Clock::time_point start = Clock::now();
+      for (LtInt32 i = 0; i < num_symbols; i++)
+         flatten(flattener, symbols[i], points);
+      best = std::min(best, std::chrono::duration<LtFloat>(Clock::now() - start).count());
+   }
+   report("templates", best, points.size(), flattener.GetNumFlattened());
+
+   // Every curve flattened from scratch
+   LtInt32 num_flattened = 0;
+   best = 1e30;
+   for (int run = 0; run < cNUM_RUNS; run++)
+   {
+      num_flattened = 0;
+      points.clear();
+      Clock::time_point start = Clock::now();
+      for (LtInt32 i = 0; i < num_symbols; i++)
+      {
+         flattener.Clear();
+         flatten(flattener, symbols[i], points);
+         num_flattened += flattener.GetNumFlattened();
+      }
+      best = std::min(best, std::chrono::duration<LtFloat>(Clock::now() - start).count());
+   }
+   report("no templates", best, points.size(), num_flattened);
+
+   // Every curve within tolerance of the exact one, full turns closed
+   LtInt32 num_bad = 0;
+   for (LtInt32 i = 0; i < num_symbols; i++)
+   {
+      const Symbol& symbol = symbols[i];
+      LtFloat deviation;
+      bool closed = true;
+      if (symbol.type == eSCROLL)
+      {
+         deviation = bezier_deviation(flattener, symbol);
+      }
+      else
+      {
+         points.clear();
+         flatten(flattener, symbol, points);
+         deviation = arc_deviation(symbol, points);
+         if (symbol.type != eDOOR)
+            closed = points[0] == points[points.size() - 2] && points[1] == points[points.size() - 1];
+      }
+
+      if (deviation > tolerance * (1 + 1e-6) || !closed)
+         num_bad++;
+   }
+   printf("%d of %d curves out of tolerance or not closed\n", num_bad, num_symbols);
+
+   return num_bad ? 1 : 0;
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+   if (argc > 3)
+   {
+      printf("Usage: CurveBench [num_symbols [tolerance]]\n");
+      return 1;
+   }
+
+   LtInt32 num_symbols = (argc > 1) ? _wtoi(argv[1]) : 1000000;
+   LtFloat tolerance = (argc > 2) ? _wtof(argv[2]) : 0.001;
+   if (num_symbols <= 0 || tolerance <= 0)
+   {
+      printf("Usage: CurveBench [num_symbols [tolerance]]\n");
+      return 1;
+   }
+
+   return do_bench(num_symbols, tolerance);
+}
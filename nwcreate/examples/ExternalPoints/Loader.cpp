@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <share.h>
 
+#include "FileSniffer.h"
 #include "PointEngine.h"
 
 // Integration between NWcreate and PointEngine. Contains NWCreate entry point and
@@ -319,6 +320,31 @@ pick_cb(LtNwcExternalLink link,
    return TRUE;
 }
 
+// Understands files whose first two values, ignoring comments, are the
+// corners of the bounding box. Lines are read as read_point reads them:
+// indented lines are skipped and anything after three numbers is ignored.
+static bool
+sniff_file(const char* data, size_t size, bool truncated)
+{
+   std::string text = FileSniffer::GetText(data, size, truncated);
+   size_t pos = 0;
+   std::string line;
+   for (int i = 0; i < 2; )
+   {
+      // Only comments in the bytes read: leave it to the load
+      if (!FileSniffer::GetLine(text, pos, '#', line))
+         return truncated;
+      if (isspace((unsigned char) line[0]))
+         continue;
+      if (FileSniffer::CountNumbers(line, 0) < 3)
+         return false;
+      i++;
+   }
+   return true;
+}
+
+static FileSniffer f_sniffer(&sniff_file);
+
 // Main NWcreate entry point to load a file. We create an external link with URI pointing
 // at the file so we can render and pick content on demand.
 static LtNwcLoadStatus LI_NWC_API 
@@ -390,6 +416,7 @@ extern "C" __declspec(dllexport) LtBoolean LI_NWC_API
 LiNwcLoaderEntry(LtNwcLoader loader_handle)
 {
    LcNwcLoader loader(loader_handle);
+   loader.SetUnderstandsFileExCallback(&FileSniffer::UnderstandsFileExCallback, &f_sniffer);
    loader.SetLoadFileExCallback(&load_file_ex_cb, NULL);
    loader.SetParameterCallback(&param_cb, NULL);
 
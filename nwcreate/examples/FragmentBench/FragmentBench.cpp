@@ -0,0 +1,352 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include <nwcreate/LiNwcAll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "GeometryRecorder.h"
+#include "FragmentTuner.h"
+
+#define LI_NWC_NO_PROGRESS_CALLBACKS NULL
+#define LI_NWC_NO_USER_DATA NULL
+
+// Piece of geometry in the corpus
+struct BenchCase
+{
+   std::wstring name;
+   GeometryRecorder geometry;
+};
+
+//
+// Synthetic corpus, used when no recorder files are given
+//
+
+// Dense, compact surface
+static void
+make_dense_surface(GeometryRecorder& r, LtFloat x0, LtFloat y0, LtFloat z0)
+{
+   const int n = 200;
+   r.Begin(LI_NWC_VERTEX_NONE);
+   for (int j = 0; j <= n; j++)
+      for (int i = 0; i <= n; i++)
+         r.IndexedVertex(x0 + i * 0.05, y0 + j * 0.05, z0 + 0.2 * sin(i * 0.1) * cos(j * 0.1));
+   for (int j = 0; j < n; j++)
+   {
+      for (int i = 0; i < n; i++)
+      {
+         LtInt32 a = j * (n + 1) + i;
+         r.TriangleIndex(a); r.TriangleIndex(a + 1); r.TriangleIndex(a + n + 1);
+         r.TriangleIndex(a + 1); r.TriangleIndex(a + n + 2); r.TriangleIndex(a + n + 1);
+      }
+   }
+   r.End();
+}
+
+// Long, sparse pipe run
+static void
+make_pipe_run(GeometryRecorder& r)
+{
+   r.Begin(LI_NWC_VERTEX_NORMAL);
+   LtPoint p = { 0, 0, 0 };
+   for (int i = 0; i < 2000; i++)
+   {
+      LtPoint q = { p[0], p[1], p[2] };
+      q[i % 3] += ((i / 3) % 2) ? -2.0 : 3.0;
+      r.Cylinder(p, q, 0.1);
+      p[0] = q[0]; p[1] = q[1]; p[2] = q[2];
+   }
+   r.End();
+}
+
+// Many small parts scattered through a large volume
+static void
+make_scattered_parts(GeometryRecorder& r)
+{
+   r.Begin(LI_NWC_VERTEX_NORMAL);
+   srand(1);
+   for (int i = 0; i < 5000; i++)
+   {
+      LtPoint a = { rand() % 1000 * 1.0, rand() % 1000 * 1.0, rand() % 100 * 1.0 };
+      LtPoint b = { a[0] + 0.5, a[1] + 0.5, a[2] + 0.5 };
+      r.Cuboid(a, b);
+   }
+   r.End();
+}
+
+static void
+make_corpus(std::vector<BenchCase*>& corpus)
+{
+   BenchCase* c = new BenchCase;
+   c->name = L"dense";
+   make_dense_surface(c->geometry, 0, 0, 0);
+   corpus.push_back(c);
+
+   c = new BenchCase;
+   c->name = L"pipes";
+   make_pipe_run(c->geometry);
+   corpus.push_back(c);
+
+   c = new BenchCase;
+   c->name = L"scattered";
+   make_scattered_parts(c->geometry);
+   corpus.push_back(c);
+
+   c = new BenchCase;
+   c->name = L"georef";
+   make_dense_surface(c->geometry, 512000, 4200000, 120);
+   corpus.push_back(c);
+}
+
+//
+// Measurements
+//
+
+// Splits positions at the median of the longest axis until each part holds
+// no more than capacity, and returns mean part diagonal over whole diagonal.
+// Stands in for how tightly fragments bound their geometry, so lower means
+// more can be culled. Only a guide: actual cull rates come from the viewer.
+static LtFloat
+cull_ratio(const GeometryRecorder& geometry, LtInt32 threshold)
+{
+   size_t n = geometry.GetNumPositions();
+   LtInt32 num_primitives = geometry.GetNumPrimitives();
+   if (n == 0 || num_primitives == 0)
+      return 1;
+
+   std::vector<LtInt32> order(n);
+   for (size_t i = 0; i < n; i++)
+      order[i] = LtInt32(i);
+
+   const ArenaColumn<LtFloat>* pos[3] =
+      { &geometry.GetPositions(0), &geometry.GetPositions(1), &geometry.GetPositions(2) };
+
+   size_t capacity = size_t(LtFloat(threshold) * n / num_primitives);
+   if (capacity < 1)
+      capacity = 1;
+
+   struct Range { size_t begin, end; };
+   std::vector<Range> todo;
+   Range all = { 0, n };
+   todo.push_back(all);
+
+   LtFloat whole = -1, sum = 0;
+   LtInt32 num_parts = 0;
+   while (!todo.empty())
+   {
+      Range range = todo.back();
+      todo.pop_back();
+
+      LtFloat lo[3], hi[3];
+      for (int k = 0; k < 3; k++)
+      {
+         lo[k] = hi[k] = (*pos[k])[order[range.begin]];
+         for (size_t i = range.begin + 1; i < range.end; i++)
+         {
+            LtFloat v = (*pos[k])[order[i]];
+            lo[k] = std::min(lo[k], v);
+            hi[k] = std::max(hi[k], v);
+         }
+      }
+      LtFloat diag = sqrt((hi[0] - lo[0]) * (hi[0] - lo[0]) +
+                          (hi[1] - lo[1]) * (hi[1] - lo[1]) +
+                          (hi[2] - lo[2]) * (hi[2] - lo[2]));
+      if (whole < 0)
+         whole = diag;
+
+      if (range.end - range.begin <= capacity || diag <= 0)
+      {
+         sum += diag;
+         num_parts++;
+         continue;
+      }
+
+      int axis = 0;
+      for (int k = 1; k < 3; k++)
+      {
+         if (hi[k] - lo[k] > hi[axis] - lo[axis])
+            axis = k;
+      }
+
+      const ArenaColumn<LtFloat>& column = *pos[axis];
+      size_t mid = (range.begin + range.end) / 2;
+      std::nth_element(order.begin() + range.begin, order.begin() + mid, order.begin() + range.end,
+                       [&column](LtInt32 a, LtInt32 b) { return column[a] < column[b]; });
+
+      Range left = { range.begin, mid };
+      Range right = { mid, range.end };
+      todo.push_back(left);
+      todo.push_back(right);
+   }
+
+   return (whole > 0) ? sum / num_parts / whole : 1;
+}
+
+static LtInt64
+file_size(const wchar_t* pathname)
+{
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"rb");
+   if (!fp)
+      return -1;
+
+   _fseeki64(fp, 0, SEEK_END);
+   LtInt64 size = _ftelli64(fp);
+   fclose(fp);
+
+   return size;
+}
+
+// NWcreate can only write cache files, so load and render time aren't
+// measured here. With keep, the files are left for timing in NavisWorks.
+static void
+run_case(const BenchCase& bench, const wchar_t* mode, const FragmentSettings& settings,
+         bool keep)
+{
+   LcNwcScene scene;
+   LcNwcGeometry geom;
+   LcNwcGeometryStream stream = geom.OpenStream();
+   settings.Apply(stream);
+   bench.geometry.Replay(stream);
+   geom.CloseStream(stream);
+   scene.AddNode(geom);
+
+   std::wstring pathname = L"fragmentbench_" + bench.name + L"_" + mode + L".nwc";
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   scene.WriteCache(L"", pathname.c_str(), LI_NWC_NO_PROGRESS_CALLBACKS, LI_NWC_NO_USER_DATA);
+   std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+   LtFloat ms = std::chrono::duration<LtFloat, std::milli>(end - start).count();
+   LtInt64 size = file_size(pathname.c_str());
+   LtFloat ratio = cull_ratio(bench.geometry, settings.spatial_split_threshold);
+
+   wprintf(L"%-12ls %-8ls %6d %6d %6d %12.1f %10.1f %10.1f %8.3f\n",
+           bench.name.c_str(), mode, settings.split_threshold,
+           settings.spatial_split_threshold, settings.merge_threshold,
+           settings.recenter_threshold, ms, size / 1024.0, ratio);
+
+   if (!keep)
+      _wremove(pathname.c_str());
+}
+
+static void
+do_bench(int argc, wchar_t* argv[])
+{
+   int first_file = 1;
+   bool keep = false;
+   if (argc > first_file && !wcscmp(argv[first_file], L"-keep"))
+   {
+      keep = true;
+      first_file++;
+   }
+
+   LtInt32 target = 500;
+   if (argc > first_file && iswdigit(argv[first_file][0]))
+   {
+      target = _wtoi(argv[first_file]);
+      first_file++;
+   }
+
+   // Recorder files written by GeometryRecorder::WriteToFile
+   std::vector<BenchCase*> corpus;
+   for (int i = first_file; i < argc; i++)
+   {
+      BenchCase* c = new BenchCase;
+      c->name = argv[i];
+      if (!c->geometry.ReadFromFile(argv[i]))
+      {
+         wprintf(L"Can't read %ls\n", argv[i]);
+         delete c;
+         continue;
+      }
+      corpus.push_back(c);
+   }
+   if (corpus.empty())
+      make_corpus(corpus);
+
+   FragmentTuner tuner(target);
+
+   wprintf(L"%-12ls %-8ls %6ls %6ls %6ls %12ls %10ls %10ls %8ls\n",
+           L"geometry", L"mode", L"split", L"spatial", L"merge", L"recenter",
+           L"write ms", L"KB", L"cull");
+
+   for (size_t i = 0; i < corpus.size(); i++)
+   {
+      run_case(*corpus[i], L"default", FragmentSettings::Defaults(), keep);
+      run_case(*corpus[i], L"tuned", tuner.Tune(corpus[i]->geometry), keep);
+      delete corpus[i];
+   }
+}
+
+void LI_NWC_API
+error_handler(LtNwcSeverity severity, LtString message, void* user_data)
+{
+   switch (severity)
+   {
+   case LI_NWC_SEVERITY_ERROR:
+      printf("Error: %s\n", message);
+      exit(1);
+      break;
+
+   case LI_NWC_SEVERITY_WARNING:
+      printf("Warning: %s\n", message);
+      break;
+
+   default:
+      printf("UNKNOWN: %s\n", message);
+      exit(1);
+      break;
+   }
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+   LiNwcApiErrorInitialise();
+
+   switch (LiNwcApiInitialise())
+   {
+   case LI_NWC_API_OK:
+      break;
+
+   case LI_NWC_API_NOT_LICENSED:
+      printf("Not Licensed\n");
+      return 1;
+
+   case LI_NWC_API_INTERNAL_ERROR:
+   default:
+      printf("Internal Error\n");
+      return 1;
+   }
+
+   LiNwcApiSetErrorHandler(&error_handler, NULL);
+   do_bench(argc, argv);
+   LiNwcApiTerminate();
+
+   printf("Done\n");
+   return 0;
+}
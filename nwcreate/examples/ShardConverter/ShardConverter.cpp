@@ -0,0 +1,244 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include <nwcreate/LiNwcAll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ColumnGeometry.h"
+#include "ColumnSpec.h"
+#include "GeometryRecorder.h"
+#include "GuidBatch.h"
+#include "SceneSharder.h"
+
+// Only circle columns are converted
+ColumnProfile ColumnSpec::m_profile = eCIRCLE;
+
+// Pathname of shard file for output pathname, with the given extension
+static std::wstring
+shard_pathname(const std::wstring& output, LtInt32 shard, LtWideString extension)
+{
+   std::wstring stem = output;
+   size_t dot = stem.rfind(L'.');
+   if (dot != std::wstring::npos && stem.find_first_of(L"\\/", dot) == std::wstring::npos)
+      stem.erase(dot);
+
+   wchar_t suffix[32];
+   swprintf_s(suffix, L"_shard%d.%ls", shard, extension);
+   return stem + suffix;
+}
+
+// Child process: converts every column of a slice of input, written to a
+// file of its own by the parent, so the child only parses its own rows.
+static int
+convert_shard(LtWideString input, LtWideString slice, LtWideString output)
+{
+   ColumnTable columns;
+   if (ColumnTable::LoadFromFile(slice, columns) != LI_NWC_LOAD_OK)
+      return 1;
+
+   LcNwcScene scene;
+   GeometryRecorder recorder;
+   GuidBatch guids;
+   for (size_t i = 0; i < columns.GetSize(); i++)
+   {
+      LtPoint base;
+      columns.GetCenter(i, base);
+
+      recorder.Clear();
+      recorder.Begin(LI_NWC_VERTEX_NORMAL);
+      stream_circle_column(recorder, base, columns.GetHeight(i));
+      recorder.End();
+
+      LcNwcGeometry geom;
+      LcNwcGeometryStream stream = geom.OpenStream();
+      recorder.ReplayRecentered(stream);
+      geom.CloseStream(stream);
+
+      geom.SetGuid(guids.AddGuidString(columns.GetGuid(i)));
+      scene.AddNode(geom);
+   }
+
+   return (scene.WriteCache(input, output, NULL, NULL) == LI_NWC_WRITE_OK) ? 0 : 1;
+}
+
+// Writes the given rows of columns as an .mlf file. Numbers are written
+// with enough digits to read back exactly.
+static bool
+write_slice(const std::wstring& pathname, const ColumnTable& columns,
+            const std::vector<LtInt32>& rows)
+{
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname.c_str(), L"wb");
+   if (!fp)
+      return false;
+
+   bool ok = true;
+   for (size_t i = 0; i < rows.size() && ok; i++)
+   {
+      LtPoint base;
+      columns.GetCenter(rows[i], base);
+      ok = fprintf(fp, "%.17g,%.17g,%.17g,%.17g,%ls\n", columns.GetHeight(rows[i]),
+                   base[0], base[1], base[2], columns.GetGuid(rows[i])) > 0;
+   }
+
+   if (fclose(fp) != 0)
+      ok = false;
+   return ok;
+}
+
+// Parent process: parses the input once, writes the rows of each shard to
+// a slice file and runs a child per slice, then writes the master scene.
+static int
+convert(LtWideString input, LtWideString output, LtInt32 num_shards)
+{
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   ColumnTable columns;
+   if (ColumnTable::LoadFromFile(input, columns) != LI_NWC_LOAD_OK)
+   {
+      printf("Can't read input\n");
+      return 1;
+   }
+
+   std::vector<LtFloat> centers(columns.GetSize() * 3);
+   for (size_t i = 0; i < columns.GetSize(); i++)
+   {
+      LtPoint center;
+      columns.GetCenter(i, center);
+      for (int k = 0; k < 3; k++)
+         centers[i * 3 + k] = center[k];
+   }
+
+   std::vector<LtInt32> shards;
+   SceneSharder::Partition(centers, num_shards, shards);
+
+   std::vector<std::vector<LtInt32> > rows(num_shards);
+   for (size_t i = 0; i < shards.size(); i++)
+      rows[shards[i]].push_back(LtInt32(i));
+
+   SceneSharder sharder;
+   std::vector<std::wstring> slices;
+   bool ok = true;
+   for (LtInt32 i = 0; i < num_shards && ok; i++)
+   {
+      std::wstring pathname = shard_pathname(output, i, L"nwc");
+      slices.push_back(shard_pathname(output, i, L"mlf"));
+      ok = write_slice(slices.back(), columns, rows[i]);
+
+      sharder.AddShard(pathname, L"-shard \"" + std::wstring(input) + L"\" \"" + slices.back() +
+                                 L"\" \"" + pathname + L"\"");
+   }
+
+   ok = ok && sharder.Run();
+
+   for (size_t i = 0; i < slices.size(); i++)
+      _wremove(slices[i].c_str());
+
+   if (!ok)
+   {
+      printf("Shard conversion failed\n");
+      return 1;
+   }
+
+   std::chrono::steady_clock::time_point shards_done = std::chrono::steady_clock::now();
+
+   if (sharder.WriteMaster(input, output) != LI_NWC_WRITE_OK)
+   {
+      printf("Can't write master scene\n");
+      return 1;
+   }
+
+   std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+   printf("%d shards: %.0f ms, master: %.0f ms\n", num_shards,
+          std::chrono::duration<LtFloat, std::milli>(shards_done - start).count(),
+          std::chrono::duration<LtFloat, std::milli>(end - shards_done).count());
+
+   return 0;
+}
+
+void LI_NWC_API
+error_handler(LtNwcSeverity severity, LtString message, void* user_data)
+{
+   switch (severity)
+   {
+   case LI_NWC_SEVERITY_ERROR:
+      printf("Error: %s\n", message);
+      exit(1);
+      break;
+
+   case LI_NWC_SEVERITY_WARNING:
+      printf("Warning: %s\n", message);
+      break;
+
+   default:
+      printf("UNKNOWN: %s\n", message);
+      exit(1);
+      break;
+   }
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+   bool child = argc == 5 && !wcscmp(argv[1], L"-shard");
+   if (!child && (argc < 3 || argc > 4))
+   {
+      printf("Usage: ShardConverter input.mlf output.nwc [num_shards]\n");
+      return 1;
+   }
+
+   LiNwcApiErrorInitialise();
+
+   switch (LiNwcApiInitialise())
+   {
+   case LI_NWC_API_OK:
+      break;
+
+   case LI_NWC_API_NOT_LICENSED:
+      printf("Not Licensed\n");
+      return 1;
+
+   case LI_NWC_API_INTERNAL_ERROR:
+   default:
+      printf("Internal Error\n");
+      return 1;
+   }
+
+   LiNwcApiSetErrorHandler(&error_handler, NULL);
+
+   int result;
+   if (child)
+   {
+      result = convert_shard(argv[2], argv[3], argv[4]);
+   }
+   else
+   {
+      LtInt32 num_shards = (argc == 4) ? _wtoi(argv[3]) : 4;
+      result = convert(argv[1], argv[2], (num_shards > 0) ? num_shards : 1);
+   }
+
+   LiNwcApiTerminate();
+
+   return result;
+}
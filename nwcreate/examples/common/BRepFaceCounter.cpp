@@ -0,0 +1,63 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+#include "BRepFaceCounter.h"
+
+#include <wchar.h>
+
+BRepFaceCounter::BRepFaceCounter()
+   : m_num_bodies(0), m_num_failed_bodies(0), m_num_failed_faces(0)
+{
+}
+
+void
+BRepFaceCounter::Count(LtInt32 num_failed_faces)
+{
+   m_num_bodies++;
+   if (num_failed_faces > 0)
+   {
+      m_num_failed_bodies++;
+      m_num_failed_faces += num_failed_faces;
+   }
+}
+
+bool
+BRepFaceCounter::BRepEntity(LcNwcGeometryStream& stream, LtNwcBRepEntity entity)
+{
+   bool ok = stream.BRepEntity(entity) != 0;
+   Count(stream.BRepNumFailedFaces());
+   return ok;
+}
+
+bool
+BRepFaceCounter::BRepShell(LcNwcGeometryStream& stream, LtNwcShell shell)
+{
+   bool ok = stream.BRepShell(shell) != 0;
+   Count(stream.BRepNumFailedFaces());
+   return ok;
+}
+
+std::wstring
+BRepFaceCounter::GetStatistics() const
+{
+   wchar_t buffer[256];
+   swprintf(buffer, 256, L"BRep faceting: %d bodies, %d failed faces in %d bodies",
+            m_num_bodies, m_num_failed_faces, m_num_failed_bodies);
+   return buffer;
+}
@@ -0,0 +1,62 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+#ifndef BREPFACECOUNTER_HDR
+#define BREPFACECOUNTER_HDR
+#pragma once
+
+#include <string>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Streams BRep bodies into geometry streams and adds up the faces NWcreate
+// failed to facet, per body, into one report for the scene statistics.
+//
+// Faceting happens inside LcNwcGeometryStream::BRepEntity and BRepShell,
+// and NWcreate may only be called from the loader thread, so the bodies
+// are faceted one after another where they are streamed.
+class BRepFaceCounter
+{
+public:
+   BRepFaceCounter();
+
+   // Facets a body into stream and counts its failed faces
+   bool BRepEntity(LcNwcGeometryStream& stream, LtNwcBRepEntity entity);
+   bool BRepShell(LcNwcGeometryStream& stream, LtNwcShell shell);
+
+   LtInt32 GetNumBodies() const { return m_num_bodies; }
+   LtInt32 GetNumFailedBodies() const { return m_num_failed_bodies; }
+   LtInt32 GetNumFailedFaces() const { return m_num_failed_faces; }
+
+   // "BRep faceting: N bodies, F failed faces in B bodies"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   BRepFaceCounter(const BRepFaceCounter&);
+   BRepFaceCounter& operator= (const BRepFaceCounter&);
+
+   void Count(LtInt32 num_failed_faces);
+
+   LtInt32 m_num_bodies;
+   LtInt32 m_num_failed_bodies;
+   LtInt32 m_num_failed_faces;
+};
+
+#endif // BREPFACECOUNTER_HDR
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "BRepTemplateCache.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+
+// Bit pattern of value rounded to a multiple of 1 / scale. Rounding stays in
+// double precision, so large parameters can't overflow an integer.
+static LtInt64
+quantize(LtFloat value, LtFloat scale)
+{
+   LtFloat rounded = floor(value * scale + 0.5);
+   if (rounded == 0)
+      rounded = 0;   // No negative zero
+
+   LtInt64 bits;
+   memcpy(&bits, &rounded, sizeof(bits));
+   return bits;
+}
+
+BRepTemplateCache::BRepTemplateCache(LtFloat tolerance)
+   : m_tolerance(tolerance), m_num_hits(0), m_num_misses(0)
+{
+}
+
+BRepTemplateCache::~BRepTemplateCache()
+{
+   Clear();
+}
+
+void
+BRepTemplateCache::Clear()
+{
+   m_templates.clear();
+   m_num_hits = 0;
+   m_num_misses = 0;
+}
+
+const LcNwcBRepEntity&
+BRepTemplateCache::Lookup(BuildFunction build, const LtFloat* params, int num_params,
+                          void* user_data)
+{
+   LtFloat scale = 1.0 / m_tolerance;
+
+   std::vector<LtInt64> key(num_params + 1);
+   key[0] = LtInt64(reinterpret_cast<intptr_t>(build));
+   for (int i = 0; i < num_params; i++)
+      key[i + 1] = quantize(params[i], scale);
+
+   std::map<std::vector<LtInt64>, LcNwcBRepEntity>::iterator found = m_templates.find(key);
+   if (found != m_templates.end())
+   {
+      m_num_hits++;
+      return found->second;
+   }
+
+   m_num_misses++;
+   return m_templates.insert(std::make_pair(key, build(params, user_data))).first->second;
+}
+
+LcNwcBRepEntity
+BRepTemplateCache::CreateCopy(BuildFunction build, const LtFloat* params, int num_params,
+                              void* user_data)
+{
+   return Lookup(build, params, num_params, user_data).Copy();
+}
+
+LcNwcBRepEntity
+BRepTemplateCache::CreateTranslated(BuildFunction build, const LtFloat* params, int num_params,
+                                    const LtVector offset, void* user_data)
+{
+   LcNwcBRepEntity entity = CreateCopy(build, params, num_params, user_data);
+   entity.Translate(offset[0], offset[1], offset[2]);
+   return entity;
+}
+
+LcNwcBRepEntity
+BRepTemplateCache::CreateTransformed(BuildFunction build, const LtFloat* params, int num_params,
+                                     LtNwcTransform transform, void* user_data)
+{
+   LcNwcBRepEntity entity = CreateCopy(build, params, num_params, user_data);
+   entity.Transform(transform);
+   return entity;
+}
+
+std::wstring
+BRepTemplateCache::GetStatistics() const
+{
+   wchar_t buffer[256];
+   swprintf(buffer, 256, L"BRep templates: %d entities, %d built",
+            m_num_hits + m_num_misses, m_num_misses);
+   return buffer;
+}
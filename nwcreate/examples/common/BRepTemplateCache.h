@@ -0,0 +1,92 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef BREPTEMPLATECACHE_HDR
+#define BREPTEMPLATECACHE_HDR
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Builds each distinct BRep entity once and hands out placed copies of it,
+// for models where many parts have the same section and size.
+//
+// An entity is described by a build function and its parameters, which
+// together are the cache key. The first request builds the template; every
+// request returns a copy of it, translated or transformed into place.
+// Copying and moving an entity is much cheaper than building its profile,
+// loop, face and sweep again.
+//
+// Templates are NWcreate objects, so Clear the cache before the API is
+// terminated, and only use it from the thread that calls NWcreate.
+class BRepTemplateCache
+{
+public:
+   // Builds the entity for params, in its own local frame
+   typedef LcNwcBRepEntity (*BuildFunction)(const LtFloat* params, void* user_data);
+
+   // Parameters closer than tolerance share a template
+   BRepTemplateCache(LtFloat tolerance = 1e-9);
+   ~BRepTemplateCache();
+
+   // Copy of the template, as built
+   LcNwcBRepEntity CreateCopy(BuildFunction build, const LtFloat* params, int num_params,
+                              void* user_data = NULL);
+
+   // Copy of the template moved by offset
+   LcNwcBRepEntity CreateTranslated(BuildFunction build, const LtFloat* params, int num_params,
+                                    const LtVector offset, void* user_data = NULL);
+
+   // Copy of the template with transform applied
+   LcNwcBRepEntity CreateTransformed(BuildFunction build, const LtFloat* params, int num_params,
+                                     LtNwcTransform transform, void* user_data = NULL);
+
+   // Destroys all templates
+   void Clear();
+
+   LtInt32 GetNumHits() const { return m_num_hits; }
+   LtInt32 GetNumMisses() const { return m_num_misses; }
+   LtInt32 GetNumTemplates() const { return LtInt32(m_templates.size()); }
+
+   // "BRep templates: N entities, M built"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   BRepTemplateCache(const BRepTemplateCache&);
+   BRepTemplateCache& operator= (const BRepTemplateCache&);
+
+   const LcNwcBRepEntity& Lookup(BuildFunction build, const LtFloat* params, int num_params,
+                                 void* user_data);
+
+   LtFloat m_tolerance;
+
+   // Keyed on build function then bit patterns of parameters rounded to
+   // multiples of m_tolerance
+   std::map<std::vector<LtInt64>, LcNwcBRepEntity> m_templates;
+   LtInt32 m_num_hits;
+   LtInt32 m_num_misses;
+};
+
+#endif // BREPTEMPLATECACHE_HDR
@@ -0,0 +1,125 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "BudgetedScene.h"
+
+#include <stdio.h>
+
+#include "SceneSharder.h"
+
+// Rough memory held by NWcreate per node, attribute and stored triangle,
+// line or point (positions, normals and indices)
+static const size_t cBYTES_PER_NODE = 256;
+static const size_t cBYTES_PER_ATTRIBUTE = 128;
+static const size_t cBYTES_PER_PRIMITIVE = 48;
+
+BudgetedScene::BudgetedScene(LtWideString source, LtWideString pathname, size_t budget_bytes)
+   : m_source(source),
+     m_pathname(pathname),
+     m_budget(budget_bytes),
+     m_scene(new LcNwcScene),
+     m_num_nodes(0),
+     m_bytes(0),
+     m_total_bytes(0),
+     m_status(LI_NWC_WRITE_OK)
+{
+}
+
+BudgetedScene::~BudgetedScene()
+{
+   delete m_scene;
+}
+
+size_t
+BudgetedScene::EstimateNode(LtInt32 num_attributes)
+{
+   return cBYTES_PER_NODE + num_attributes * cBYTES_PER_ATTRIBUTE;
+}
+
+size_t
+BudgetedScene::EstimateGeometry(const GeometryRecorder& recorder, LtInt32 num_attributes)
+{
+   return EstimateNode(num_attributes) + recorder.GetNumPrimitives() * cBYTES_PER_PRIMITIVE;
+}
+
+bool
+BudgetedScene::AddNode(LtNwcNode node, size_t bytes)
+{
+   m_scene->AddNode(node);
+   m_num_nodes++;
+   m_bytes += bytes;
+   m_total_bytes += bytes;
+
+   if (m_budget && m_bytes >= m_budget)
+      return Spill();
+   return true;
+}
+
+std::wstring
+BudgetedScene::GetPartPathname(LtInt32 part) const
+{
+   std::wstring stem = m_pathname;
+   size_t dot = stem.rfind(L'.');
+   if (dot != std::wstring::npos && stem.find_first_of(L"\\/", dot) == std::wstring::npos)
+      stem.erase(dot);
+
+   wchar_t suffix[32];
+   swprintf(suffix, 32, L"_part%d.nwc", part);
+   return stem + suffix;
+}
+
+bool
+BudgetedScene::Spill()
+{
+   std::wstring part = GetPartPathname(GetNumParts());
+   m_status = m_scene->WriteCache(m_source.c_str(), part.c_str(), NULL, NULL);
+   if (m_status != LI_NWC_WRITE_OK)
+      return false;
+
+   m_parts.push_back(part);
+
+   // Releases everything added so far
+   delete m_scene;
+   m_scene = new LcNwcScene;
+   m_num_nodes = 0;
+   m_bytes = 0;
+
+   return true;
+}
+
+LtNwcWriteStatus
+BudgetedScene::Write()
+{
+   if (m_status != LI_NWC_WRITE_OK)
+      return m_status;
+
+   if (m_parts.empty())
+   {
+      m_status = m_scene->WriteCache(m_source.c_str(), m_pathname.c_str(), NULL, NULL);
+      return m_status;
+   }
+
+   if (m_num_nodes && !Spill())
+      return m_status;
+
+   m_status = SceneSharder::WriteMaster(m_parts, m_source.c_str(), m_pathname.c_str());
+   return m_status;
+}
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef BUDGETEDSCENE_HDR
+#define BUDGETEDSCENE_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "GeometryRecorder.h"
+
+// Builds a scene within a memory budget. Each finished subtree is added
+// with an estimate of the memory it holds, and once the total crosses the
+// budget the scene so far is written out as a part file and a fresh scene
+// is started. Write then references every part from a small master scene,
+// as SceneSharder does, so a large conversion writes several parts rather
+// than failing with LI_NWC_WRITE_OUT_OF_MEMORY at the very end.
+//
+// Estimates are rough, the budget should leave room for what NWcreate
+// needs while writing.
+class BudgetedScene
+{
+public:
+   // Parts are written next to pathname as <name>_partN.nwc, with source as
+   // the original file of every cache, the master included. A zero budget
+   // never spills.
+   BudgetedScene(LtWideString source, LtWideString pathname, size_t budget_bytes);
+   ~BudgetedScene();
+
+   // Scene being built. Replaced after each spill, so scene wide settings
+   // are best made just before Write.
+   LcNwcScene& GetScene() { return *m_scene; }
+
+   // Adds a finished subtree holding about bytes of memory, spilling if the
+   // budget is crossed. False if a spill couldn't be written.
+   bool AddNode(LtNwcNode node, size_t bytes);
+
+   // Approximate memory of a node with some attributes, and of a geometry
+   // node replayed from recorder.
+   static size_t EstimateNode(LtInt32 num_attributes = 0);
+   static size_t EstimateGeometry(const GeometryRecorder& recorder, LtInt32 num_attributes = 0);
+
+   // Writes pathname. Without spills it is a cache of the whole scene,
+   // otherwise the last part is written and pathname references the parts.
+   LtNwcWriteStatus Write();
+
+   LtInt32 GetNumParts() const { return LtInt32(m_parts.size()); }
+   size_t GetBytes() const { return m_bytes; }
+   size_t GetTotalBytes() const { return m_total_bytes; }
+   LtNwcWriteStatus GetStatus() const { return m_status; }
+
+private:
+   // Can't copy
+   BudgetedScene(const BudgetedScene&);
+   BudgetedScene& operator= (const BudgetedScene&);
+
+   bool Spill();
+   std::wstring GetPartPathname(LtInt32 part) const;
+
+   std::wstring m_source;
+   std::wstring m_pathname;
+   size_t m_budget;
+   LcNwcScene* m_scene;
+   LtInt32 m_num_nodes;                // In current scene
+   size_t m_bytes;                     // Estimate for current scene
+   size_t m_total_bytes;
+   std::vector<std::wstring> m_parts;
+   LtNwcWriteStatus m_status;
+};
+
+#endif // BUDGETEDSCENE_HDR
@@ -0,0 +1,217 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "ConversionManifest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <windows.h>
+
+// Manifest file format, one tab separated line per entry
+static const wchar_t* cMANIFEST_HEADER = L"NWCMANIFEST 1";
+
+static const LtNat64 cFNV_OFFSET = 0xcbf29ce484222325ULL;
+static const LtNat64 cFNV_PRIME = 0x100000001b3ULL;
+
+static LtNat64
+hash_bytes(LtNat64 hash, const void* data, size_t size)
+{
+   const LtNat8* bytes = static_cast<const LtNat8*>(data);
+   for (size_t i = 0; i < size; i++)
+   {
+      hash ^= bytes[i];
+      hash *= cFNV_PRIME;
+   }
+   return hash;
+}
+
+bool
+ConversionManifest::Read(LtWideString pathname)
+{
+   m_entries.clear();
+
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"r, ccs=UTF-8");
+   if (!fp)
+      return false;
+
+   std::vector<wchar_t> line(4096);
+   bool ok = fgetws(&line[0], int(line.size()), fp) != NULL &&
+             wcsncmp(&line[0], cMANIFEST_HEADER, wcslen(cMANIFEST_HEADER)) == 0;
+
+   while (ok && fgetws(&line[0], int(line.size()), fp))
+   {
+      // input <tab> output <tab> content hash <tab> options hash
+      std::wstring text(&line[0]);
+      size_t tab1 = text.find(L'\t');
+      size_t tab2 = (tab1 == std::wstring::npos) ? tab1 : text.find(L'\t', tab1 + 1);
+      size_t tab3 = (tab2 == std::wstring::npos) ? tab2 : text.find(L'\t', tab2 + 1);
+      if (tab3 == std::wstring::npos)
+      {
+         ok = false;
+         break;
+      }
+
+      Entry entry;
+      entry.output = text.substr(tab1 + 1, tab2 - tab1 - 1);
+      entry.content_hash = _wcstoui64(text.c_str() + tab2 + 1, NULL, 16);
+      entry.options_hash = _wcstoui64(text.c_str() + tab3 + 1, NULL, 16);
+      m_entries[text.substr(0, tab1)] = entry;
+   }
+
+   fclose(fp);
+
+   if (!ok)
+      m_entries.clear();
+   return ok;
+}
+
+bool
+ConversionManifest::Write(LtWideString pathname) const
+{
+   std::wstring temp_pathname = std::wstring(pathname) + L".tmp";
+
+   FILE* fp = NULL;
+   _wfopen_s(&fp, temp_pathname.c_str(), L"w, ccs=UTF-8");
+   if (!fp)
+      return false;
+
+   bool ok = fwprintf(fp, L"%ls\n", cMANIFEST_HEADER) >= 0;
+
+   std::map<std::wstring, Entry>::const_iterator it;
+   for (it = m_entries.begin(); ok && it != m_entries.end(); ++it)
+   {
+      ok = fwprintf(fp, L"%ls\t%ls\t%016llx\t%016llx\n", it->first.c_str(),
+                    it->second.output.c_str(), it->second.content_hash,
+                    it->second.options_hash) >= 0;
+   }
+
+   ok = (fclose(fp) == 0) && ok;
+   if (ok)
+      ok = MoveFileExW(temp_pathname.c_str(), pathname, MOVEFILE_REPLACE_EXISTING) != 0;
+   if (!ok)
+      _wremove(temp_pathname.c_str());
+
+   return ok;
+}
+
+bool
+ConversionManifest::IsCurrent(const std::wstring& input, const std::wstring& output,
+                              LtNat64 content_hash, LtNat64 options_hash) const
+{
+   std::map<std::wstring, Entry>::const_iterator it = m_entries.find(input);
+   if (it == m_entries.end())
+      return false;
+
+   const Entry& entry = it->second;
+   if (entry.output != output || entry.content_hash != content_hash ||
+       entry.options_hash != options_hash)
+      return false;
+
+   // Also rejects missing caches and those from another NWcreate version
+   return LiNwcApiIsCacheValid(input.c_str(), output.c_str());
+}
+
+void
+ConversionManifest::Set(const std::wstring& input, const std::wstring& output,
+                        LtNat64 content_hash, LtNat64 options_hash)
+{
+   Entry& entry = m_entries[input];
+   entry.output = output;
+   entry.content_hash = content_hash;
+   entry.options_hash = options_hash;
+}
+
+bool
+ConversionManifest::HashFile(LtWideString pathname, LtNat64& hash)
+{
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"rb");
+   if (!fp)
+      return false;
+
+   std::vector<char> buffer(1 << 20);
+   hash = cFNV_OFFSET;
+
+   size_t size;
+   while ((size = fread(&buffer[0], 1, buffer.size(), fp)) > 0)
+      hash = hash_bytes(hash, &buffer[0], size);
+
+   bool ok = !ferror(fp);
+   fclose(fp);
+
+   return ok;
+}
+
+LtNat64
+ConversionManifest::HashOptions(const LcNwcOptionSet& options,
+                                const char* const names[], LtInt32 num_names)
+{
+   LtNat64 hash = cFNV_OFFSET;
+
+   for (LtInt32 i = 0; i < num_names; i++)
+   {
+      hash = hash_bytes(hash, names[i], strlen(names[i]) + 1);
+
+      LcNwcData value;
+      if (!options.GetOption(names[i], value))
+         continue;
+
+      LtInt32 type = value.GetType();
+      hash = hash_bytes(hash, &type, sizeof(type));
+
+      LtFloat f = 0;
+      switch (value.GetType())
+      {
+      case LI_NWC_DATA_FLOAT: f = value.GetFloat(); break;
+      case LI_NWC_DATA_LINEAR_FLOAT: f = value.GetLinearFloat(); break;
+      case LI_NWC_DATA_ANGULAR_FLOAT: f = value.GetAngularFloat(); break;
+      case LI_NWC_DATA_AREA_FLOAT: f = value.GetAreaFloat(); break;
+      case LI_NWC_DATA_VOLUME_FLOAT: f = value.GetVolumeFloat(); break;
+      case LI_NWC_DATA_INT32: f = value.GetInt32(); break;
+      case LI_NWC_DATA_BOOLEAN: f = value.GetBoolean() ? 1 : 0; break;
+
+      case LI_NWC_DATA_WIDESTRING:
+         {
+            LtWideString s = value.GetWideString();
+            if (s)
+               hash = hash_bytes(hash, s, wcslen(s) * sizeof(wchar_t));
+         }
+         break;
+
+      case LI_NWC_DATA_NAME:
+         {
+            LtWideString user_name = NULL;
+            LtString s = value.GetName(&user_name);
+            if (s)
+               hash = hash_bytes(hash, s, strlen(s));
+         }
+         break;
+
+      default:
+         break;
+      }
+      hash = hash_bytes(hash, &f, sizeof(f));
+   }
+
+   return hash;
+}
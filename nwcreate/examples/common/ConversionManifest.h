@@ -0,0 +1,88 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef CONVERSIONMANIFEST_HDR
+#define CONVERSIONMANIFEST_HDR
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Record of what each cache file was converted from, so a batch converter
+// can skip inputs that haven't changed since their cache was written.
+//
+// An entry holds a hash of the input file's contents and a hash of the
+// options it was converted with. A cache is current only if both hashes
+// still match, the output is the one recorded, and LiNwcApiIsCacheValid
+// accepts it. Content hashes catch edits that keep the file time, and
+// copies that change it without changing the contents.
+class ConversionManifest
+{
+public:
+   struct Entry
+   {
+      std::wstring output;
+      LtNat64 content_hash;
+      LtNat64 options_hash;
+   };
+
+   ConversionManifest() {}
+
+   // Replaces entries with those in file. False, leaving the manifest
+   // empty, if the file is missing or unreadable.
+   bool Read(LtWideString pathname);
+
+   // Written to a temporary file and then moved over pathname, so an
+   // interrupted run leaves the previous manifest.
+   bool Write(LtWideString pathname) const;
+
+   // True if output was converted from input with the same hashes and is
+   // a valid cache for it
+   bool IsCurrent(const std::wstring& input, const std::wstring& output,
+                  LtNat64 content_hash, LtNat64 options_hash) const;
+
+   // Records a successful conversion
+   void Set(const std::wstring& input, const std::wstring& output,
+            LtNat64 content_hash, LtNat64 options_hash);
+
+   // Forgets input, e.g. after a failed conversion
+   void Remove(const std::wstring& input) { m_entries.erase(input); }
+
+   LtInt32 GetNumEntries() const { return LtInt32(m_entries.size()); }
+
+   // 64 bit FNV-1a hash of file contents. False if it can't be read.
+   static bool HashFile(LtWideString pathname, LtNat64& hash);
+
+   // Hash of the named options' types and values
+   static LtNat64 HashOptions(const LcNwcOptionSet& options,
+                              const char* const names[], LtInt32 num_names);
+
+private:
+   // Can't copy
+   ConversionManifest(const ConversionManifest&);
+   ConversionManifest& operator= (const ConversionManifest&);
+
+   std::map<std::wstring, Entry> m_entries;     // By input pathname
+};
+
+#endif // CONVERSIONMANIFEST_HDR
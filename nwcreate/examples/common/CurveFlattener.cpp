@@ -0,0 +1,290 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+#include "CurveFlattener.h"
+
+#include <math.h>
+#include <string.h>
+#include <wchar.h>
+#include <algorithm>
+
+#define         LI_PI                   3.14159265358979323846
+
+// Segment counts are multiples of this, so nearby sizes share templates
+static const LtInt32 cSEGMENT_STEP = 4;
+static const LtInt32 cMAX_SEGMENTS = 4096;
+
+// Sweeps closer than this share a template
+static const LtFloat cSWEEP_QUANTUM = 1e-9;
+
+// Segment count n rounded up to a multiple of cSEGMENT_STEP, within limits
+static LtInt32
+round_segments(LtFloat n)
+{
+   if (n > cMAX_SEGMENTS)
+      n = cMAX_SEGMENTS;
+   LtInt32 segments = (LtInt32(n) + cSEGMENT_STEP - 1) / cSEGMENT_STEP * cSEGMENT_STEP;
+   return (segments < cSEGMENT_STEP) ? cSEGMENT_STEP : segments;
+}
+
+// Bit pattern of the sweep rounded to cSWEEP_QUANTUM
+static LtInt64
+sweep_key(LtFloat sweep)
+{
+   LtFloat rounded = floor(sweep / cSWEEP_QUANTUM + 0.5);
+
+   LtInt64 bits;
+   memcpy(&bits, &rounded, sizeof(bits));
+   return bits;
+}
+
+CurveFlattener::CurveFlattener(LtFloat tolerance, LtFloat zoom)
+   : m_tolerance(tolerance), m_zoom(zoom), m_num_curves(0), m_num_flattened(0)
+{
+}
+
+CurveFlattener::~CurveFlattener()
+{
+}
+
+void
+CurveFlattener::Clear()
+{
+   m_arcs.clear();
+   m_beziers.clear();
+   m_num_curves = 0;
+   m_num_flattened = 0;
+}
+
+// Chord error allowed, in drawing units
+LtFloat
+CurveFlattener::GetDeviation() const
+{
+   return (m_zoom > 0) ? m_tolerance / m_zoom : m_tolerance;
+}
+
+// Segments for a sweep of an arc whose larger radius is extent
+LtInt32
+CurveFlattener::Segments(LtFloat extent, LtFloat sweep) const
+{
+   LtFloat deviation = GetDeviation();
+
+   LtFloat n = cMAX_SEGMENTS;
+   if (deviation > 0 && extent <= deviation)
+      n = 1;
+   else if (deviation > 0)
+      n = ceil(sweep / (2 * acos(1 - deviation / extent)));
+
+   return round_segments(n);
+}
+
+const CurveFlattener::ArcTemplate&
+CurveFlattener::LookupArc(LtInt32 segments, LtFloat sweep)
+{
+   std::pair<LtInt32, LtInt64> key(segments, sweep_key(sweep));
+   std::map<std::pair<LtInt32, LtInt64>, ArcTemplate>::iterator found = m_arcs.find(key);
+   if (found != m_arcs.end())
+      return found->second;
+
+   m_num_flattened++;
+   ArcTemplate& arc = m_arcs[key];
+   arc.cos.resize(segments + 1);
+   arc.sin.resize(segments + 1);
+   for (LtInt32 i = 0; i <= segments; i++)
+   {
+      LtFloat a = sweep * i / segments;
+      arc.cos[i] = cos(a);
+      arc.sin[i] = sin(a);
+   }
+
+   // Full turns close exactly
+   if (sweep == 2 * LI_PI)
+   {
+      arc.cos[segments] = 1;
+      arc.sin[segments] = 0;
+   }
+   return arc;
+}
+
+const CurveFlattener::BezierTemplate&
+CurveFlattener::LookupBezier(LtInt32 segments)
+{
+   std::map<LtInt32, BezierTemplate>::iterator found = m_beziers.find(segments);
+   if (found != m_beziers.end())
+      return found->second;
+
+   m_num_flattened++;
+   BezierTemplate& bezier = m_beziers[segments];
+   for (int k = 0; k < 4; k++)
+      bezier.weights[k].resize(segments + 1);
+   for (LtInt32 i = 0; i <= segments; i++)
+   {
+      LtFloat t = LtFloat(i) / segments, u = 1 - t;
+      bezier.weights[0][i] = u * u * u;
+      bezier.weights[1][i] = 3 * u * u * t;
+      bezier.weights[2][i] = 3 * u * t * t;
+      bezier.weights[3][i] = t * t * t;
+   }
+   return bezier;
+}
+
+void
+CurveFlattener::Place(const ArcTemplate& arc, const LtPoint2d center, const LtFloat m[4],
+                      std::vector<LtFloat>& points) const
+{
+   size_t num_points = arc.cos.size();
+   size_t first = points.size();
+   points.resize(first + num_points * 2);
+
+   const LtFloat* c = &arc.cos[0];
+   const LtFloat* s = &arc.sin[0];
+   LtFloat* out = &points[first];
+   for (size_t i = 0; i < num_points; i++)
+   {
+      out[i * 2] = center[0] + m[0] * c[i] + m[1] * s[i];
+      out[i * 2 + 1] = center[1] + m[2] * c[i] + m[3] * s[i];
+   }
+}
+
+void
+CurveFlattener::Circle(const LtPoint2d center, LtFloat radius, std::vector<LtFloat>& points)
+{
+   Ellipse(center, radius, radius, 0, points);
+}
+
+void
+CurveFlattener::Ellipse(const LtPoint2d center, LtFloat major_radius, LtFloat minor_radius,
+                        LtFloat rotation, std::vector<LtFloat>& points)
+{
+   Arc(center, major_radius, minor_radius, 0, 2 * LI_PI, LI_NWC_PLOT_ARC_SWEEP_COUNTERCLOCKWISE,
+       rotation, points);
+}
+
+void
+CurveFlattener::Arc(const LtPoint2d center, LtFloat major_radius, LtFloat minor_radius,
+                    LtFloat start, LtFloat end, LtNwcPlotArcSweepDirection direction,
+                    LtFloat rotation, std::vector<LtFloat>& points)
+{
+   m_num_curves++;
+
+   // Sweep from start to end in the given direction, a full turn if they meet
+   LtFloat sweep = (direction == LI_NWC_PLOT_ARC_SWEEP_CLOCKWISE) ? start - end : end - start;
+   sweep = fmod(sweep, 2 * LI_PI);
+   if (sweep <= 0)
+      sweep += 2 * LI_PI;
+   LtFloat sign = (direction == LI_NWC_PLOT_ARC_SWEEP_CLOCKWISE) ? -1 : 1;
+
+   LtFloat extent = std::max(fabs(major_radius), fabs(minor_radius));
+   const ArcTemplate& arc = LookupArc(Segments(extent, sweep), sweep);
+
+   // Rotate by start, flip for clockwise, scale to radii then rotate the
+   // ellipse, as one matrix
+   LtFloat cs = cos(start), ss = sin(start);
+   LtFloat cr = cos(rotation), sr = sin(rotation);
+   LtFloat a = major_radius * cs, b = -major_radius * ss * sign;
+   LtFloat c = minor_radius * ss, d = minor_radius * cs * sign;
+   LtFloat m[4] = { cr * a - sr * c, cr * b - sr * d,
+                    sr * a + cr * c, sr * b + cr * d };
+
+   Place(arc, center, m, points);
+}
+
+void
+CurveFlattener::PolyBezier(const LtPoint2d* control_points, LtInt32 num_points,
+                           std::vector<LtFloat>& points)
+{
+   LtFloat deviation = GetDeviation();
+
+   for (LtInt32 i = 0; i + 3 < num_points; i += 3)
+   {
+      m_num_curves++;
+      const LtPoint2d* p = control_points + i;
+
+      // Chord error of n segments is at most 3/4 of the largest second
+      // difference over n squared
+      LtFloat dd = 0;
+      for (int k = 0; k < 2; k++)
+      {
+         LtFloat dx = p[k][0] - 2 * p[k + 1][0] + p[k + 2][0];
+         LtFloat dy = p[k][1] - 2 * p[k + 1][1] + p[k + 2][1];
+         dd = std::max(dd, sqrt(dx * dx + dy * dy));
+      }
+      LtFloat n = (deviation > 0) ? ceil(sqrt(0.75 * dd / deviation)) : cMAX_SEGMENTS;
+      LtInt32 segments = round_segments(n);
+
+      const BezierTemplate& bezier = LookupBezier(segments);
+      const LtFloat* w0 = &bezier.weights[0][0];
+      const LtFloat* w1 = &bezier.weights[1][0];
+      const LtFloat* w2 = &bezier.weights[2][0];
+      const LtFloat* w3 = &bezier.weights[3][0];
+
+      // Curves after the first start at the end of the previous one
+      LtInt32 first_point = (i == 0) ? 0 : 1;
+      size_t first = points.size();
+      points.resize(first + (segments + 1 - first_point) * 2);
+      LtFloat* out = &points[first];
+      for (LtInt32 j = first_point; j <= segments; j++, out += 2)
+      {
+         out[0] = w0[j] * p[0][0] + w1[j] * p[1][0] + w2[j] * p[2][0] + w3[j] * p[3][0];
+         out[1] = w0[j] * p[0][1] + w1[j] * p[1][1] + w2[j] * p[2][1] + w3[j] * p[3][1];
+      }
+   }
+}
+
+void
+CurveFlattener::PolyLineSegment(LcNwcPlotGeometryStream stream, bool is_stroked,
+                                const std::vector<LtFloat>& points)
+{
+   stream.PolyLineSegmentBegin(is_stroked);
+   for (size_t i = 0; i + 1 < points.size(); i += 2)
+   {
+      LtPoint2d point = { points[i], points[i + 1] };
+      stream.PolyLineSegmentPoint(point);
+   }
+   stream.PolyLineSegmentEnd();
+}
+
+void
+CurveFlattener::PolyTriangleSegment(LcNwcPlotGeometryStream stream, const LtPoint2d center,
+                                    const std::vector<LtFloat>& points)
+{
+   LtPoint2d apex = { center[0], center[1] };
+
+   // Three points per triangle, apex first. Read as a strip instead, the
+   // triangles in between repeat or are degenerate, so it draws the same.
+   stream.PolyTriangleSegmentBegin();
+   for (size_t i = 0; i + 3 < points.size(); i += 2)
+   {
+      LtPoint2d a = { points[i], points[i + 1] };
+      LtPoint2d b = { points[i + 2], points[i + 3] };
+      stream.PolyTriangleSegmentPoint(apex);
+      stream.PolyTriangleSegmentPoint(a);
+      stream.PolyTriangleSegmentPoint(b);
+   }
+   stream.PolyTriangleSegmentEnd();
+}
+
+std::wstring
+CurveFlattener::GetStatistics() const
+{
+   wchar_t buffer[256];
+   swprintf(buffer, 256, L"Curve flattening: %d curves, %d flattened, %d templates",
+            m_num_curves, m_num_flattened, GetNumTemplates());
+   return buffer;
+}
@@ -0,0 +1,131 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+#ifndef CURVEFLATTENER_HDR
+#define CURVEFLATTENER_HDR
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Flattens plot curves to points, for streaming as polylines or triangles
+// where analytic segments are slow to draw or aren't wanted.
+//
+// The chord error is at most tolerance / zoom, in paper units, where zoom
+// is the deepest zoom the drawing should still look smooth at. Segment
+// counts are rounded up to a multiple of four, and the points for a given
+// count and sweep are worked out once and kept: every circle, ellipse and
+// arc is a scaled, rotated and translated copy of a unit arc, and every
+// cubic Bezier a weighted sum of its control points. Repeated symbols, such
+// as door swings and bolt circles, are only flattened once, whatever their
+// position, size and rotation.
+//
+// Points are appended to a vector as x, y pairs, both ends included.
+// Methods take the same parameters as the plot curve segments. Not thread
+// safe; use one flattener per thread.
+class CurveFlattener
+{
+public:
+   CurveFlattener(LtFloat tolerance = 0.001, LtFloat zoom = 1);
+   ~CurveFlattener();
+
+   void SetTolerance(LtFloat tolerance) { m_tolerance = tolerance; }
+   LtFloat GetTolerance() const { return m_tolerance; }
+   void SetZoom(LtFloat zoom) { m_zoom = zoom; }
+
+   // Full turns, closed exactly with the first point repeated
+   void Circle(const LtPoint2d center, LtFloat radius, std::vector<LtFloat>& points);
+   void Ellipse(const LtPoint2d center, LtFloat major_radius, LtFloat minor_radius,
+                LtFloat rotation, std::vector<LtFloat>& points);
+
+   // As LcNwcPlotArcSegment, radians being parametric angles on the ellipse
+   void Arc(const LtPoint2d center, LtFloat major_radius, LtFloat minor_radius,
+            LtFloat start, LtFloat end, LtNwcPlotArcSweepDirection direction,
+            LtFloat rotation, std::vector<LtFloat>& points);
+
+   // As PolyBezierSegment: a start point then three control points per
+   // cubic curve
+   void PolyBezier(const LtPoint2d* control_points, LtInt32 num_points,
+                   std::vector<LtFloat>& points);
+
+   // Streams points as one polyline segment
+   static void PolyLineSegment(LcNwcPlotGeometryStream stream, bool is_stroked,
+                               const std::vector<LtFloat>& points);
+
+   // Streams the region between center and points as a fan of triangles, a
+   // filled disc or sector without a fill rule
+   static void PolyTriangleSegment(LcNwcPlotGeometryStream stream, const LtPoint2d center,
+                                   const std::vector<LtFloat>& points);
+
+   // Forgets all flattened templates
+   void Clear();
+
+   // Starts counting again, keeping the templates
+   void ClearStatistics() { m_num_curves = m_num_flattened = 0; }
+
+   LtInt32 GetNumCurves() const { return m_num_curves; }
+   LtInt32 GetNumFlattened() const { return m_num_flattened; }
+   LtInt32 GetNumTemplates() const { return LtInt32(m_arcs.size() + m_beziers.size()); }
+
+   // "Curve flattening: N curves, F flattened, M templates"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   CurveFlattener(const CurveFlattener&);
+   CurveFlattener& operator= (const CurveFlattener&);
+
+   // Unit arc from angle zero, n + 1 points
+   struct ArcTemplate
+   {
+      std::vector<LtFloat> cos;
+      std::vector<LtFloat> sin;
+   };
+
+   // Bernstein weights of the four control points, n + 1 points
+   struct BezierTemplate
+   {
+      std::vector<LtFloat> weights[4];
+   };
+
+   LtFloat GetDeviation() const;
+   LtInt32 Segments(LtFloat extent, LtFloat sweep) const;
+   const ArcTemplate& LookupArc(LtInt32 segments, LtFloat sweep);
+   const BezierTemplate& LookupBezier(LtInt32 segments);
+
+   // Appends center + m * template point for each template point
+   void Place(const ArcTemplate& arc, const LtPoint2d center, const LtFloat m[4],
+              std::vector<LtFloat>& points) const;
+
+   LtFloat m_tolerance;
+   LtFloat m_zoom;
+
+   // Keyed on segments and the bit pattern of the sweep, rounded to
+   // cSWEEP_QUANTUM
+   std::map<std::pair<LtInt32, LtInt64>, ArcTemplate> m_arcs;
+   std::map<LtInt32, BezierTemplate> m_beziers;
+
+   LtInt32 m_num_curves;
+   LtInt32 m_num_flattened;
+};
+
+#endif // CURVEFLATTENER_HDR
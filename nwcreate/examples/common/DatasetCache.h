@@ -0,0 +1,204 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef DATASETCACHE_HDR
+#define DATASETCACHE_HDR
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <wchar.h>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "MappedFile.h"
+
+// Parsed contents of source files, shared by every sheet loaded from them.
+//
+// A loader keeps one static cache. load_fileinfo_cb calls Prefetch to start
+// parsing on a worker thread while NavisWorks reads the sheet list, and
+// each load_file_sheet_cb calls Get, which waits for that parse or parses
+// now if there wasn't one. Entries are keyed on pathname and checked
+// against the file's size and write time, so an edited file is parsed
+// again. The least recently used file is dropped once more than
+// max_entries are held.
+//
+// Parsed data is shared between threads and must be treated as read only.
+template <class T>
+class DatasetCache
+{
+public:
+   typedef LtNwcLoadStatus (*LoadFunction)(LtWideString pathname, T& data);
+
+   DatasetCache(LoadFunction load, size_t max_entries = 2)
+      : m_load(load), m_max_entries(max_entries), m_clock(0), m_serial(0),
+        m_num_parsed(0), m_num_shared(0) {}
+
+   // Starts parsing pathname on a worker thread unless it's cached
+   void Prefetch(LtWideString pathname)
+   {
+      Find(pathname, true);
+   }
+
+   // Parsed data for pathname, NULL if it couldn't be loaded
+   std::shared_ptr<const T> Get(LtWideString pathname, LtNwcLoadStatus& status)
+   {
+      LtInt64 serial;
+      std::shared_future<Result> result = Find(pathname, false, &serial);
+      status = result.get().status;
+
+      // Failures aren't kept, so the next request tries again. The entry
+      // may have been replaced by a newer parse meanwhile, which stays.
+      if (status != LI_NWC_LOAD_OK)
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         typename std::map<std::wstring, Entry>::iterator it = m_entries.find(pathname);
+         if (it != m_entries.end() && it->second.serial == serial)
+            m_entries.erase(it);
+      }
+
+      return result.get().data;
+   }
+
+   // Waits for parses still running, outside the lock
+   void Clear()
+   {
+      std::map<std::wstring, Entry> entries;
+      std::lock_guard<std::mutex> lock(m_mutex);
+      entries.swap(m_entries);
+   }
+
+   // Number of parses, and of requests answered by an earlier parse
+   LtInt32 GetNumParsed() const { return m_num_parsed; }
+   LtInt32 GetNumShared() const { return m_num_shared; }
+
+   // "Datasets: N parsed, M shared", for the loader's scene statistics
+   std::wstring GetStatistics() const
+   {
+      wchar_t buffer[128];
+      swprintf(buffer, 128, L"Datasets: %d parsed, %d shared", GetNumParsed(), GetNumShared());
+      return buffer;
+   }
+
+private:
+   // Can't copy
+   DatasetCache(const DatasetCache&);
+   DatasetCache& operator= (const DatasetCache&);
+
+   struct Result
+   {
+      LtNwcLoadStatus status;
+      std::shared_ptr<const T> data;
+   };
+
+   struct Entry
+   {
+      FileStamp stamp;
+      std::shared_future<Result> result;
+      LtInt64 last_used;
+      LtInt64 serial;                  // Tells a replaced entry from its successor
+   };
+
+   static Result Load(LoadFunction load, std::wstring pathname)
+   {
+      Result result;
+      std::shared_ptr<T> data(new T);
+      result.status = load(pathname.c_str(), *data);
+      if (result.status == LI_NWC_LOAD_OK)
+         result.data = data;
+      return result;
+   }
+
+   // Destroying the last future of a running std::async parse waits for
+   // it, so a future replaced here goes in retired, which is destroyed
+   // after the lock is released.
+   std::shared_future<Result> Find(LtWideString pathname, bool async, LtInt64* serial = NULL)
+   {
+      FileStamp stamp = { -1, -1 };
+      FileStamp::Get(pathname, stamp);
+
+      std::vector<std::shared_future<Result> > retired;
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      typename std::map<std::wstring, Entry>::iterator it = m_entries.find(pathname);
+      if (it != m_entries.end() && it->second.stamp == stamp)
+      {
+         it->second.last_used = ++m_clock;
+         if (!async)
+            m_num_shared++;
+         if (serial)
+            *serial = it->second.serial;
+         return it->second.result;
+      }
+
+      if (it == m_entries.end() && m_entries.size() >= m_max_entries)
+         Evict();
+      else if (it != m_entries.end())
+         retired.push_back(it->second.result);
+
+      // Parsed here, or on a worker thread for a prefetch. Waiting on the
+      // future then runs or joins the parse.
+      Entry& entry = m_entries[pathname];
+      entry.stamp = stamp;
+      entry.last_used = ++m_clock;
+      entry.serial = ++m_serial;
+      entry.result = std::async(async ? std::launch::async : std::launch::deferred,
+                                &DatasetCache::Load, m_load, std::wstring(pathname)).share();
+      m_num_parsed++;
+      if (serial)
+         *serial = entry.serial;
+      return entry.result;
+   }
+
+   // Drops the least recently used entry whose parse isn't running. If
+   // every parse is running the cache holds one entry too many for now.
+   void Evict()
+   {
+      typename std::map<std::wstring, Entry>::iterator oldest = m_entries.end();
+      for (typename std::map<std::wstring, Entry>::iterator it = m_entries.begin();
+           it != m_entries.end(); ++it)
+      {
+         if (it->second.result.wait_for(std::chrono::seconds(0)) == std::future_status::timeout)
+            continue;
+         if (oldest == m_entries.end() || it->second.last_used < oldest->second.last_used)
+            oldest = it;
+      }
+      if (oldest != m_entries.end())
+         m_entries.erase(oldest);
+   }
+
+   LoadFunction m_load;
+   size_t m_max_entries;
+   std::mutex m_mutex;
+   std::map<std::wstring, Entry> m_entries;
+   LtInt64 m_clock;
+   LtInt64 m_serial;
+   std::atomic<LtInt32> m_num_parsed;
+   std::atomic<LtInt32> m_num_shared;
+};
+
+#endif // DATASETCACHE_HDR
@@ -0,0 +1,172 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "FileSniffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <windows.h>
+
+FileSniffer::FileSniffer(SniffFunction sniff, size_t max_bytes, size_t max_entries)
+   : m_sniff(sniff),
+     m_max_bytes(max_bytes),
+     m_max_entries(max_entries),
+     m_num_read(0),
+     m_num_cached(0)
+{
+}
+
+bool
+FileSniffer::Understands(LtWideString pathname)
+{
+   FileStamp stamp;
+   if (!FileStamp::Get(pathname, stamp))
+      return false;
+
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::unordered_map<std::wstring, Verdict>::const_iterator it = m_verdicts.find(pathname);
+      if (it != m_verdicts.end() && it->second.stamp == stamp)
+      {
+         m_num_cached++;
+         return it->second.understands;
+      }
+   }
+
+   // Read outside the lock, so a slow network file doesn't hold up others
+   bool understands = Sniff(pathname, stamp);
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+   if (m_verdicts.size() >= m_max_entries)
+      m_verdicts.clear();
+   Verdict& verdict = m_verdicts[pathname];
+   verdict.stamp = stamp;
+   verdict.understands = understands;
+   m_num_read++;
+
+   return understands;
+}
+
+bool
+FileSniffer::Sniff(LtWideString pathname, const FileStamp& stamp)
+{
+   HANDLE file = CreateFileW(pathname, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+   std::vector<char> buffer(m_max_bytes);
+   DWORD size = 0;
+   BOOL ok = ReadFile(file, buffer.data(), DWORD(buffer.size()), &size, NULL);
+   CloseHandle(file);
+
+   if (!ok)
+      return false;
+   return m_sniff(buffer.data(), size, LtInt64(size) < stamp.size);
+}
+
+bool LI_NWC_API
+FileSniffer::UnderstandsFileExCallback(LtNwcLoader loader, LtWideString pathname,
+                                       LtNwcLoaderSpec child_loader_spec, void* user_data)
+{
+   return static_cast<FileSniffer*>(user_data)->Understands(pathname);
+}
+
+std::string
+FileSniffer::GetText(const char* data, size_t size, bool truncated)
+{
+   const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+   std::string text;
+
+   if (size >= 2 && ((p[0] == 0xff && p[1] == 0xfe) || (p[0] == 0xfe && p[1] == 0xff)))
+   {
+      // UTF-16, little or big endian
+      bool little = (p[0] == 0xff);
+      text.reserve(size / 2);
+      for (size_t i = 2; i + 1 < size; i += 2)
+      {
+         unsigned c = little ? (p[i] | p[i + 1] << 8) : (p[i] << 8 | p[i + 1]);
+         text += (c < 0x80) ? char(c) : '?';
+      }
+   }
+   else
+   {
+      size_t start = (size >= 3 && p[0] == 0xef && p[1] == 0xbb && p[2] == 0xbf) ? 3 : 0;
+      text.reserve(size - start);
+      for (size_t i = start; i < size; i++)
+         text += (p[i] < 0x80) ? char(p[i]) : '?';
+   }
+
+   if (truncated)
+   {
+      size_t end = text.find_last_of("\r\n");
+      text.erase((end == std::string::npos) ? 0 : end + 1);
+   }
+
+   return text;
+}
+
+bool
+FileSniffer::GetLine(const std::string& text, size_t& pos, char comment, std::string& line)
+{
+   while (pos < text.size())
+   {
+      size_t end = text.find_first_of("\r\n", pos);
+      if (end == std::string::npos)
+         end = text.size();
+
+      size_t first = text.find_first_not_of(" \t", pos);
+      bool blank = (first == std::string::npos || first >= end);
+      bool skip = blank || (comment && text[first] == comment);
+
+      if (!skip)
+         line.assign(text, pos, end - pos);
+      pos = end + 1;
+      if (!skip)
+         return true;
+   }
+   return false;
+}
+
+LtInt32
+FileSniffer::CountNumbers(const std::string& text, char separator)
+{
+   LtInt32 num = 0;
+   const char* p = text.c_str();
+   for (;;)
+   {
+      while (*p == ' ' || *p == '\t')
+         p++;
+
+      char* end;
+      strtod(p, &end);
+      if (end == p)
+         return num;
+      num++;
+
+      p = end;
+      while (*p == ' ' || *p == '\t')
+         p++;
+      if (separator && *p == separator)
+         p++;
+   }
+}
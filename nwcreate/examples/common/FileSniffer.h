@@ -0,0 +1,99 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef FILESNIFFER_HDR
+#define FILESNIFFER_HDR
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "MappedFile.h"
+
+// Answers the understands file callback for a loader from the first few
+// hundred bytes of a file, so Navisworks can probe files with a shared or
+// misleading extension without a full load.
+//
+// At most max_bytes are read from the start of the file and passed to a
+// sniff function that matches magic numbers or a header. Verdicts are kept
+// per pathname with the file's size and write time, so scanning the same
+// directory again costs one file attribute query per file. Up to
+// max_entries verdicts are kept before the cache starts again. Safe to call
+// from several threads.
+class FileSniffer
+{
+public:
+   // True if the loader reads a file starting with data. truncated if the
+   // file is longer than size bytes.
+   typedef bool (*SniffFunction)(const char* data, size_t size, bool truncated);
+
+   FileSniffer(SniffFunction sniff, size_t max_bytes = 512, size_t max_entries = 4096);
+
+   bool Understands(LtWideString pathname);
+
+   // For LcNwcLoader::SetUnderstandsFileExCallback, with the sniffer as
+   // user data
+   static bool LI_NWC_API
+   UnderstandsFileExCallback(LtNwcLoader loader, LtWideString pathname,
+                             LtNwcLoaderSpec child_loader_spec, void* user_data);
+
+   // Number of files read, and of verdicts answered from the cache
+   LtInt32 GetNumRead() const { return m_num_read; }
+   LtInt32 GetNumCached() const { return m_num_cached; }
+
+   // Helpers for sniffing text formats. GetText returns the data as 8 bit
+   // text, from UTF-8 or UTF-16 with a byte order mark, with anything
+   // outside ASCII as '?'. If the data was cut short at max_bytes, the
+   // last, partial line is dropped.
+   static std::string GetText(const char* data, size_t size, bool truncated);
+   // Reads the next line that isn't blank or a comment starting with
+   // comment (0 for none). False at the end of the text.
+   static bool GetLine(const std::string& text, size_t& pos, char comment, std::string& line);
+   // Number of numbers at the start of text, separated by whitespace and
+   // optionally by separator (0 for none)
+   static LtInt32 CountNumbers(const std::string& text, char separator);
+
+private:
+   // Can't copy
+   FileSniffer(const FileSniffer&);
+   FileSniffer& operator= (const FileSniffer&);
+
+   bool Sniff(LtWideString pathname, const FileStamp& stamp);
+
+   struct Verdict
+   {
+      FileStamp stamp;
+      bool understands;
+   };
+
+   SniffFunction m_sniff;
+   size_t m_max_bytes;
+   size_t m_max_entries;
+   std::mutex m_mutex;
+   std::unordered_map<std::wstring, Verdict> m_verdicts;
+   LtInt32 m_num_read;
+   LtInt32 m_num_cached;
+};
+
+#endif // FILESNIFFER_HDR
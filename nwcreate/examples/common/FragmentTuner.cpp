@@ -0,0 +1,154 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "FragmentTuner.h"
+
+#include <math.h>
+#include <vector>
+
+// Cells along longest side of occupancy grid
+static const LtInt32 cGRID_CELLS = 16;
+
+// Limits on chosen thresholds
+static const LtInt32 cMIN_SPLIT = 16;
+static const LtInt32 cMIN_MERGE = 4;
+static const LtInt32 cMAX_FRAGMENTS = 4096;
+
+FragmentSettings
+FragmentSettings::Defaults()
+{
+   FragmentSettings settings;
+   settings.split_threshold = 100;
+   settings.spatial_split_threshold = 500;
+   settings.merge_threshold = 25;
+   settings.recenter_threshold = 0;
+   return settings;
+}
+
+FragmentTuner::FragmentTuner(LtInt32 target_size)
+   : m_target_size(target_size)
+{
+   if (m_target_size < cMIN_SPLIT)
+      m_target_size = cMIN_SPLIT;
+}
+
+void
+FragmentTuner::Analyze(const GeometryRecorder& geometry, FragmentAnalysis& analysis)
+{
+   analysis.num_primitives = geometry.GetNumPrimitives();
+   analysis.occupancy = 1;
+   for (int k = 0; k < 3; k++)
+      analysis.min[k] = analysis.max[k] = 0;
+
+   size_t n = geometry.GetNumPositions();
+   if (n == 0)
+      return;
+
+   const ArenaColumn<LtFloat>* pos[3] =
+      { &geometry.GetPositions(0), &geometry.GetPositions(1), &geometry.GetPositions(2) };
+
+   for (int k = 0; k < 3; k++)
+   {
+      analysis.min[k] = analysis.max[k] = (*pos[k])[0];
+      for (size_t i = 1; i < n; i++)
+      {
+         LtFloat v = (*pos[k])[i];
+         if (v < analysis.min[k]) analysis.min[k] = v;
+         if (v > analysis.max[k]) analysis.max[k] = v;
+      }
+   }
+
+   // Grid with roughly cubic cells, flat directions get a single cell
+   LtFloat longest = 0;
+   for (int k = 0; k < 3; k++)
+   {
+      if (analysis.max[k] - analysis.min[k] > longest)
+         longest = analysis.max[k] - analysis.min[k];
+   }
+   if (longest <= 0)
+      return;
+
+   LtInt32 cells[3];
+   for (int k = 0; k < 3; k++)
+   {
+      cells[k] = LtInt32(cGRID_CELLS * (analysis.max[k] - analysis.min[k]) / longest + 0.5);
+      if (cells[k] < 1)
+         cells[k] = 1;
+   }
+
+   std::vector<bool> occupied(cells[0] * cells[1] * cells[2], false);
+   LtInt32 num_occupied = 0;
+   for (size_t i = 0; i < n; i++)
+   {
+      LtInt32 c[3];
+      for (int k = 0; k < 3; k++)
+      {
+         LtFloat extent = analysis.max[k] - analysis.min[k];
+         c[k] = (extent > 0) ? LtInt32(cells[k] * ((*pos[k])[i] - analysis.min[k]) / extent) : 0;
+         if (c[k] >= cells[k])
+            c[k] = cells[k] - 1;
+      }
+
+      size_t cell = (size_t(c[2]) * cells[1] + c[1]) * cells[0] + c[0];
+      if (!occupied[cell])
+      {
+         occupied[cell] = true;
+         num_occupied++;
+      }
+   }
+
+   analysis.occupancy = LtFloat(num_occupied) / occupied.size();
+}
+
+FragmentSettings
+FragmentTuner::Tune(const GeometryRecorder& geometry, FragmentAnalysis* analysis) const
+{
+   FragmentAnalysis local;
+   if (!analysis)
+      analysis = &local;
+   Analyze(geometry, *analysis);
+
+   FragmentSettings settings = FragmentSettings::Defaults();
+   if (analysis->num_primitives == 0)
+      return settings;
+
+   // Keep the default proportions between thresholds
+   LtFloat spatial = m_target_size * (0.5 + analysis->occupancy);
+   if (analysis->num_primitives / spatial > cMAX_FRAGMENTS)
+      spatial = LtFloat(analysis->num_primitives) / cMAX_FRAGMENTS;
+
+   settings.spatial_split_threshold = LtInt32(spatial);
+   settings.split_threshold = LtInt32(spatial / 5);
+   settings.merge_threshold = LtInt32(spatial / 20);
+   if (settings.split_threshold < cMIN_SPLIT)
+      settings.split_threshold = cMIN_SPLIT;
+   if (settings.merge_threshold < cMIN_MERGE)
+      settings.merge_threshold = cMIN_MERGE;
+
+   LtFloat size = 0;
+   for (int k = 0; k < 3; k++)
+   {
+      LtFloat extent = analysis->max[k] - analysis->min[k];
+      size += extent * extent;
+   }
+   settings.recenter_threshold = sqrt(size);
+
+   return settings;
+}
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef FRAGMENTTUNER_HDR
+#define FRAGMENTTUNER_HDR
+#pragma once
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "GeometryRecorder.h"
+
+// Geometry stream fragmenting thresholds
+struct FragmentSettings
+{
+   LtInt32 split_threshold;
+   LtInt32 spatial_split_threshold;
+   LtInt32 merge_threshold;
+   LtFloat recenter_threshold;
+
+   // Stream defaults, as documented in LiNwcGeometryStream.h
+   static FragmentSettings Defaults();
+
+   // Sets thresholds on an LcNwcGeometryStream or GeometryRecorder.
+   // Call before any geometry is defined.
+   template <class Stream> void Apply(Stream& stream) const
+   {
+      stream.SplitThreshold(split_threshold);
+      stream.SpatialSplitThreshold(spatial_split_threshold);
+      stream.MergeThreshold(merge_threshold);
+      stream.RecenterThreshold(recenter_threshold);
+   }
+};
+
+// Measurements that settings are derived from
+struct FragmentAnalysis
+{
+   LtInt32 num_primitives;
+   LtPoint min;
+   LtPoint max;
+   LtFloat occupancy;      // Fraction of bounding box cells holding vertices
+};
+
+// Chooses fragmenting thresholds for a piece of recorded geometry, aiming
+// for fragments of around the target number of primitives.
+//
+// Geometry that only fills a small part of its bounding box (pipe runs,
+// frames) is split spatially sooner, so each fragment has tight bounds and
+// can be culled on its own. Dense, compact geometry gains little from
+// spatial splits and is left in larger fragments. Very large geometry has
+// its thresholds raised so the number of fragments, and so write time,
+// stays bounded. Geometry further from the origin than its own size is
+// recentered.
+class FragmentTuner
+{
+public:
+   FragmentTuner(LtInt32 target_size = 500);
+
+   LtInt32 GetTargetSize() const { return m_target_size; }
+
+   FragmentSettings Tune(const GeometryRecorder& geometry, FragmentAnalysis* analysis = 0) const;
+
+   // Measures geometry without choosing settings
+   static void Analyze(const GeometryRecorder& geometry, FragmentAnalysis& analysis);
+
+private:
+   LtInt32 m_target_size;
+};
+
+#endif // FRAGMENTTUNER_HDR
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "GeometryArena.h"
+
+#include <stdlib.h>
+
+GeometryArena::GeometryArena(size_t block_size)
+   : m_block_size(block_size), m_head(0), m_bytes_allocated(0), m_bytes_reserved(0)
+{
+}
+
+GeometryArena::~GeometryArena()
+{
+   while (m_head)
+   {
+      Block* next = m_head->next;
+      free(m_head);
+      m_head = next;
+   }
+}
+
+GeometryArena::Block*
+GeometryArena::NewBlock(size_t min_size)
+{
+   size_t size = (min_size > m_block_size) ? min_size : m_block_size;
+
+   Block* block = static_cast<Block*>(malloc(sizeof(Block) + size));
+   block->next = m_head;
+   block->size = size;
+   block->used = 0;
+   m_head = block;
+   m_bytes_reserved += size;
+
+   return block;
+}
+
+void*
+GeometryArena::Allocate(size_t size, size_t align)
+{
+   Block* block = m_head;
+   size_t offset = 0;
+
+   if (block)
+   {
+      offset = (block->used + align - 1) & ~(align - 1);
+      if (offset + size > block->size)
+         block = 0;
+   }
+
+   if (!block)
+   {
+      block = NewBlock(size + align);
+      offset = 0;
+   }
+
+   // Data area starts directly after header, which keeps double alignment
+   char* base = reinterpret_cast<char*>(block + 1);
+   block->used = offset + size;
+   m_bytes_allocated += size;
+
+   return base + offset;
+}
+
+void
+GeometryArena::Reset()
+{
+   if (!m_head)
+      return;
+
+   // Oldest block is at the tail of the list, keep that one
+   Block* keep = m_head;
+   while (keep->next)
+   {
+      Block* next = keep->next;
+      m_bytes_reserved -= keep->size;
+      free(keep);
+      keep = next;
+   }
+
+   keep->used = 0;
+   m_head = keep;
+   m_bytes_allocated = 0;
+}
@@ -0,0 +1,137 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef GEOMETRYARENA_HDR
+#define GEOMETRYARENA_HDR
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// Simple bump allocator. Memory is handed out from large blocks and is only
+// released all at once by Reset or on destruction. Not thread safe, use one
+// arena per thread.
+class GeometryArena
+{
+public:
+   GeometryArena(size_t block_size = 256 * 1024);
+   ~GeometryArena();
+
+   void* Allocate(size_t size, size_t align = sizeof(double));
+
+   // Releases all allocations. Keeps the first block for reuse.
+   void Reset();
+
+   size_t GetBytesAllocated() const { return m_bytes_allocated; }
+   size_t GetBytesReserved() const { return m_bytes_reserved; }
+
+private:
+   // Can't copy
+   GeometryArena(const GeometryArena&);
+   GeometryArena& operator= (const GeometryArena&);
+
+   struct Block
+   {
+      Block* next;
+      size_t size;
+      size_t used;
+   };
+
+   Block* NewBlock(size_t min_size);
+
+   size_t m_block_size;
+   Block* m_head;
+   size_t m_bytes_allocated;
+   size_t m_bytes_reserved;
+};
+
+// Append only column of plain values stored in fixed size chunks allocated
+// from an arena. Elements never move once written so growing a column never
+// copies, and each chunk is contiguous for tight loops.
+template <class T>
+class ArenaColumn
+{
+public:
+   enum { cCHUNK_SHIFT = 10, cCHUNK_SIZE = 1 << cCHUNK_SHIFT };
+
+   ArenaColumn() : m_arena(0), m_size(0) {}
+
+   void SetArena(GeometryArena* arena) { m_arena = arena; }
+
+   void PushBack(const T& value)
+   {
+      size_t offset = m_size & (cCHUNK_SIZE - 1);
+      if (offset == 0)
+         m_chunks.push_back(static_cast<T*>(m_arena->Allocate(sizeof(T) * cCHUNK_SIZE, sizeof(T))));
+      m_chunks.back()[offset] = value;
+      m_size ++;
+   }
+
+   const T& operator[] (size_t i) const
+   { return m_chunks[i >> cCHUNK_SHIFT][i & (cCHUNK_SIZE - 1)]; }
+   T& operator[] (size_t i)
+   { return m_chunks[i >> cCHUNK_SHIFT][i & (cCHUNK_SIZE - 1)]; }
+
+   size_t Size() const { return m_size; }
+   size_t GetNumChunks() const { return m_chunks.size(); }
+   const T* GetChunk(size_t i) const { return m_chunks[i]; }
+   size_t GetChunkSize(size_t i) const
+   { return (i + 1 < m_chunks.size()) ? size_t(cCHUNK_SIZE) : m_size - (i << cCHUNK_SHIFT); }
+
+   // Forgets contents. Memory is returned when the owning arena is reset.
+   void Clear() { m_chunks.clear(); m_size = 0; }
+
+private:
+   GeometryArena* m_arena;
+   std::vector<T*> m_chunks;
+   size_t m_size;
+};
+
+// Sequential reader over an ArenaColumn. Avoids index arithmetic per element.
+template <class T>
+class ArenaColumnReader
+{
+public:
+   ArenaColumnReader(const ArenaColumn<T>& column)
+      : m_column(column), m_chunk(0), m_pos(0), m_end(0)
+   {
+      if (m_column.GetNumChunks())
+         m_end = m_column.GetChunkSize(0);
+   }
+
+   const T& Next()
+   {
+      if (m_pos == m_end)
+      {
+         m_chunk ++;
+         m_pos = 0;
+         m_end = m_column.GetChunkSize(m_chunk);
+      }
+      return m_column.GetChunk(m_chunk)[m_pos++];
+   }
+
+private:
+   const ArenaColumn<T>& m_column;
+   size_t m_chunk;
+   size_t m_pos;
+   size_t m_end;
+};
+
+#endif // GEOMETRYARENA_HDR
@@ -0,0 +1,500 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "GeometryInstancer.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// Relative thresholds used to decide whether principal axes are well defined
+static const LtFloat cEIGEN_GAP = 1e-4;
+static const LtFloat cSKEW_MIN = 1e-3;
+
+// Values are hashed on a grid this many tolerances apart, and matched within
+// tolerance on a hash hit. Two values within tolerance only land in different
+// cells if a cell boundary falls between them, so the coarser the grid the
+// rarer a missed match, at the cost of comparing more near misses.
+static const LtFloat cHASH_GRID = 1024;
+
+//
+// Hashing
+//
+
+static inline void
+hash_bytes(LtNat64& hash, const void* data, size_t size)
+{
+   const LtNat8* p = static_cast<const LtNat8*>(data);
+   for (size_t i = 0; i < size; i++)
+   {
+      hash ^= p[i];
+      hash *= 1099511628211ULL;
+   }
+}
+
+template <class T>
+static void
+hash_exact(LtNat64& hash, const ArenaColumn<T>& column)
+{
+   for (size_t i = 0; i < column.GetNumChunks(); i++)
+      hash_bytes(hash, column.GetChunk(i), column.GetChunkSize(i) * sizeof(T));
+}
+
+static void
+hash_quantized(LtNat64& hash, const ArenaColumn<LtFloat>& column, LtFloat quantum)
+{
+   LtFloat scale = 1.0 / quantum;
+   for (size_t i = 0; i < column.GetNumChunks(); i++)
+   {
+      const LtFloat* values = column.GetChunk(i);
+      size_t n = column.GetChunkSize(i);
+      for (size_t j = 0; j < n; j++)
+      {
+         LtInt64 q = LtInt64(floor(values[j] * scale + 0.5));
+         hash_bytes(hash, &q, sizeof(q));
+      }
+   }
+}
+
+static LtNat64
+hash_geometry(const GeometryRecorder& geometry, LtFloat quantum)
+{
+   LtNat64 hash = 14695981039346656037ULL;
+
+   hash_exact(hash, geometry.GetOps());
+   hash_exact(hash, geometry.GetInts());
+   for (int i = 0; i < 3; i++)
+   {
+      hash_quantized(hash, geometry.GetPositions(i), quantum);
+      hash_quantized(hash, geometry.GetDirections(i), quantum);
+   }
+   for (int i = 0; i < 4; i++)
+      hash_quantized(hash, geometry.GetColors(i), quantum);
+   for (int i = 0; i < 2; i++)
+      hash_quantized(hash, geometry.GetTexCoords(i), quantum);
+   hash_quantized(hash, geometry.GetScalars(), quantum);
+
+   return hash;
+}
+
+//
+// Comparison
+//
+
+template <class T>
+static bool
+equal_exact(const ArenaColumn<T>& a, const ArenaColumn<T>& b)
+{
+   if (a.Size() != b.Size())
+      return false;
+
+   for (size_t i = 0; i < a.Size(); i++)
+   {
+      if (a[i] != b[i])
+         return false;
+   }
+
+   return true;
+}
+
+static bool
+equal_within(const ArenaColumn<LtFloat>& a, const ArenaColumn<LtFloat>& b, LtFloat tolerance)
+{
+   if (a.Size() != b.Size())
+      return false;
+
+   for (size_t i = 0; i < a.Size(); i++)
+   {
+      if (fabs(a[i] - b[i]) > tolerance)
+         return false;
+   }
+
+   return true;
+}
+
+static bool
+equal_geometry(const GeometryRecorder& a, const GeometryRecorder& b, LtFloat tolerance)
+{
+   if (!equal_exact(a.GetOps(), b.GetOps()) || !equal_exact(a.GetInts(), b.GetInts()))
+      return false;
+
+   for (int i = 0; i < 3; i++)
+   {
+      if (!equal_within(a.GetPositions(i), b.GetPositions(i), tolerance) ||
+          !equal_within(a.GetDirections(i), b.GetDirections(i), tolerance))
+         return false;
+   }
+   for (int i = 0; i < 4; i++)
+   {
+      if (!equal_within(a.GetColors(i), b.GetColors(i), tolerance))
+         return false;
+   }
+   for (int i = 0; i < 2; i++)
+   {
+      if (!equal_within(a.GetTexCoords(i), b.GetTexCoords(i), tolerance))
+         return false;
+   }
+
+   return equal_within(a.GetScalars(), b.GetScalars(), tolerance);
+}
+
+//
+// Canonical frame
+//
+
+// Eigen decomposition of symmetric 3x3 matrix by cyclic Jacobi rotations.
+// Eigenvector i is returned in column i of vectors.
+static void
+jacobi_eigen(LtFloat a[3][3], LtFloat values[3], LtFloat vectors[3][3])
+{
+   for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+         vectors[i][j] = (i == j) ? 1.0 : 0.0;
+
+   for (int sweep = 0; sweep < 50; sweep++)
+   {
+      LtFloat off = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+      if (off < 1e-30)
+         break;
+
+      for (int p = 0; p < 2; p++)
+      {
+         for (int q = p + 1; q < 3; q++)
+         {
+            if (fabs(a[p][q]) < 1e-30)
+               continue;
+
+            LtFloat theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+            LtFloat t = ((theta >= 0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+            LtFloat c = 1 / sqrt(t * t + 1);
+            LtFloat s = t * c;
+
+            for (int k = 0; k < 3; k++)
+            {
+               LtFloat akp = a[k][p], akq = a[k][q];
+               a[k][p] = c * akp - s * akq;
+               a[k][q] = s * akp + c * akq;
+            }
+            for (int k = 0; k < 3; k++)
+            {
+               LtFloat apk = a[p][k], aqk = a[q][k];
+               a[p][k] = c * apk - s * aqk;
+               a[q][k] = s * apk + c * aqk;
+            }
+            for (int k = 0; k < 3; k++)
+            {
+               LtFloat vkp = vectors[k][p], vkq = vectors[k][q];
+               vectors[k][p] = c * vkp - s * vkq;
+               vectors[k][q] = s * vkp + c * vkq;
+            }
+         }
+      }
+   }
+
+   for (int i = 0; i < 3; i++)
+      values[i] = a[i][i];
+}
+
+// Works out frame that geometry is canonicalized in. Rows of rotation are the
+// frame axes in world space. Falls back to translation only if axes are
+// ambiguous, e.g. for symmetric shapes.
+static bool
+canonical_frame(const GeometryRecorder& geometry, bool allow_rotation,
+                LtFloat rotation[3][3], LtVector centroid)
+{
+   for (int i = 0; i < 3; i++)
+   {
+      centroid[i] = 0;
+      for (int j = 0; j < 3; j++)
+         rotation[i][j] = (i == j) ? 1.0 : 0.0;
+   }
+
+   size_t n = geometry.GetNumPositions();
+   if (n == 0)
+      return false;
+
+   const ArenaColumn<LtFloat>& px = geometry.GetPositions(0);
+   const ArenaColumn<LtFloat>& py = geometry.GetPositions(1);
+   const ArenaColumn<LtFloat>& pz = geometry.GetPositions(2);
+
+   for (size_t i = 0; i < n; i++)
+   {
+      centroid[0] += px[i];
+      centroid[1] += py[i];
+      centroid[2] += pz[i];
+   }
+   for (int k = 0; k < 3; k++)
+      centroid[k] /= LtFloat(n);
+
+   if (!allow_rotation)
+      return true;
+
+   LtFloat cov[3][3] = { {0, 0, 0}, {0, 0, 0}, {0, 0, 0} };
+   for (size_t i = 0; i < n; i++)
+   {
+      LtFloat d[3] = { px[i] - centroid[0], py[i] - centroid[1], pz[i] - centroid[2] };
+      for (int r = 0; r < 3; r++)
+         for (int c = 0; c < 3; c++)
+            cov[r][c] += d[r] * d[c];
+   }
+
+   LtFloat values[3], vectors[3][3];
+   jacobi_eigen(cov, values, vectors);
+
+   // Sort axes by decreasing variance
+   int order[3] = { 0, 1, 2 };
+   for (int i = 0; i < 2; i++)
+      for (int j = i + 1; j < 3; j++)
+         if (values[order[j]] > values[order[i]])
+         {
+            int t = order[i]; order[i] = order[j]; order[j] = t;
+         }
+
+   LtFloat l0 = values[order[0]], l1 = values[order[1]], l2 = values[order[2]];
+   if (l0 <= 0 || (l0 - l1) < cEIGEN_GAP * l0 || (l1 - l2) < cEIGEN_GAP * l0)
+      return true;
+
+   LtFloat axes[3][3];
+   for (int a = 0; a < 2; a++)
+   {
+      for (int k = 0; k < 3; k++)
+         axes[a][k] = vectors[k][order[a]];
+
+      // Resolve sign of axis using third moment along it
+      LtFloat skew = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+         LtFloat t = (px[i] - centroid[0]) * axes[a][0] +
+                     (py[i] - centroid[1]) * axes[a][1] +
+                     (pz[i] - centroid[2]) * axes[a][2];
+         skew += t * t * t;
+      }
+
+      LtFloat sigma = sqrt(values[order[a]] / LtFloat(n));
+      if (fabs(skew) < cSKEW_MIN * LtFloat(n) * sigma * sigma * sigma)
+         return true;
+
+      if (skew < 0)
+         for (int k = 0; k < 3; k++)
+            axes[a][k] = -axes[a][k];
+   }
+
+   // Right handed, so mirror images don't match
+   axes[2][0] = axes[0][1] * axes[1][2] - axes[0][2] * axes[1][1];
+   axes[2][1] = axes[0][2] * axes[1][0] - axes[0][0] * axes[1][2];
+   axes[2][2] = axes[0][0] * axes[1][1] - axes[0][1] * axes[1][0];
+
+   for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+         rotation[i][j] = axes[i][j];
+
+   return true;
+}
+
+//
+// GeometryInstancer
+//
+
+GeometryInstancer::GeometryInstancer(LtFloat tolerance)
+   : m_tolerance(tolerance)
+   , m_recenter(true)
+{
+}
+
+GeometryInstancer::~GeometryInstancer()
+{
+   for (size_t i = 0; i < m_shapes.size(); i++)
+   {
+      delete m_shapes[i].geometry;
+      delete m_shapes[i].node;
+   }
+}
+
+LtInt32
+GeometryInstancer::FindShape(LtNat64 hash, const GeometryRecorder& canonical) const
+{
+   typedef std::unordered_multimap<LtNat64, LtInt32>::const_iterator Iterator;
+   std::pair<Iterator, Iterator> range = m_lookup.equal_range(hash);
+
+   for (Iterator it = range.first; it != range.second; ++it)
+   {
+      if (equal_geometry(*m_shapes[it->second].geometry, canonical, m_tolerance))
+         return it->second;
+   }
+
+   return -1;
+}
+
+LtInt32
+GeometryInstancer::Add(const GeometryRecorder& geometry)
+{
+   static const LtFloat identity[3][3] = { {1, 0, 0}, {0, 1, 0}, {0, 0, 1} };
+   static const LtVector zero = { 0, 0, 0 };
+
+   Instance instance;
+   instance.shape = -1;
+
+   // Geometry with its own transforms or no positions can't be moved into a
+   // canonical frame, store as is.
+   bool instanceable = !geometry.HasTransforms() &&
+      canonical_frame(geometry, !geometry.HasAxisAlignedPrimitives(),
+                      instance.rotation, instance.offset);
+
+   if (!instanceable)
+   {
+      for (int i = 0; i < 3; i++)
+         for (int j = 0; j < 3; j++)
+            instance.rotation[i][j] = identity[i][j];
+      instance.offset[0] = instance.offset[1] = instance.offset[2] = 0;
+      instance.rotated = false;
+
+      Shape shape;
+      shape.geometry = new GeometryRecorder(&m_arena);
+      shape.geometry->AppendTransformed(geometry, identity, zero);
+      shape.num_uses = 1;
+      shape.node = NULL;
+
+      instance.shape = LtInt32(m_shapes.size());
+      m_shapes.push_back(shape);
+      m_instances.push_back(instance);
+      return LtInt32(m_instances.size() - 1);
+   }
+
+   instance.rotated = (instance.rotation[0][0] != 1 || instance.rotation[1][1] != 1 ||
+                       instance.rotation[2][2] != 1);
+
+   // World to canonical: q = rotation * (p - centroid)
+   LtVector offset;
+   for (int k = 0; k < 3; k++)
+   {
+      offset[k] = -(instance.rotation[k][0] * instance.offset[0] +
+                    instance.rotation[k][1] * instance.offset[1] +
+                    instance.rotation[k][2] * instance.offset[2]);
+   }
+
+   m_scratch_arena.Reset();
+   GeometryRecorder canonical(&m_scratch_arena);
+   canonical.AppendTransformed(geometry, instance.rotation, offset);
+
+   LtNat64 hash = hash_geometry(canonical, m_tolerance * cHASH_GRID);
+   instance.shape = FindShape(hash, canonical);
+
+   if (instance.shape >= 0)
+   {
+      m_shapes[instance.shape].num_uses ++;
+   }
+   else
+   {
+      Shape shape;
+      shape.geometry = new GeometryRecorder(&m_arena);
+      shape.geometry->AppendTransformed(canonical, identity, zero);
+      shape.num_uses = 1;
+      shape.node = NULL;
+
+      instance.shape = LtInt32(m_shapes.size());
+      m_shapes.push_back(shape);
+      m_lookup.insert(std::make_pair(hash, instance.shape));
+   }
+
+   m_instances.push_back(instance);
+   return LtInt32(m_instances.size() - 1);
+}
+
+LcNwcNode
+GeometryInstancer::CreateNode(LtInt32 id)
+{
+   const Instance& instance = m_instances[id];
+   Shape& shape = m_shapes[instance.shape];
+
+   if (shape.num_uses == 1)
+   {
+      // Only used once, put geometry back where it was
+      LtFloat to_world[3][3];
+      for (int i = 0; i < 3; i++)
+         for (int j = 0; j < 3; j++)
+            to_world[i][j] = instance.rotation[j][i];
+
+      m_scratch_arena.Reset();
+      GeometryRecorder world(&m_scratch_arena);
+      world.AppendTransformed(*shape.geometry, to_world, instance.offset);
+
+      LcNwcGeometry geom;
+      LcNwcGeometryStream stream = geom.OpenStream();
+      if (m_recenter)
+         world.ReplayRecentered(stream);
+      else
+         world.Replay(stream);
+      geom.CloseStream(stream);
+      return geom;
+   }
+
+   if (!shape.node)
+   {
+      shape.node = new LcNwcGeometry;
+      LcNwcGeometryStream stream = shape.node->OpenStream();
+      shape.geometry->Replay(stream);
+      shape.node->CloseStream(stream);
+   }
+
+   LcNwcGroup group;
+   group.SetInsert(true);
+   group.AddNode(*shape.node);
+
+   if (instance.rotated)
+   {
+      // Row major, rotation rows are the canonical axes, translation in last row
+      LtFloat matrix[16];
+      for (int i = 0; i < 3; i++)
+      {
+         for (int j = 0; j < 3; j++)
+            matrix[i * 4 + j] = instance.rotation[i][j];
+         matrix[i * 4 + 3] = 0;
+         matrix[12 + i] = instance.offset[i];
+      }
+      matrix[15] = 1;
+
+      LcNwcTransform transform(matrix, false);
+      group.AddAttribute(transform);
+   }
+   else
+   {
+      LcNwcTransform transform(instance.offset[0], instance.offset[1], instance.offset[2]);
+      group.AddAttribute(transform);
+   }
+
+   return group;
+}
+
+LtFloat
+GeometryInstancer::GetDeduplicationRatio() const
+{
+   if (m_instances.empty())
+      return 0;
+
+   return 1.0 - LtFloat(m_shapes.size()) / LtFloat(m_instances.size());
+}
+
+std::wstring
+GeometryInstancer::GetStatistics() const
+{
+   wchar_t buffer[256];
+   swprintf(buffer, 256, L"Instancing: %d geometries, %d unique shapes, %.1f%% deduplicated",
+            GetNumInstances(), GetNumShapes(), GetDeduplicationRatio() * 100);
+   return buffer;
+}
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef GEOMETRYINSTANCER_HDR
+#define GEOMETRYINSTANCER_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "GeometryRecorder.h"
+
+// Detects repeated geometry by hashing its content in a canonical frame.
+// Each piece of geometry is moved so its centroid is at the origin and, when
+// its principal axes are well defined, rotated onto them. Geometry that
+// matches a shape seen before (within tolerance) becomes a transformed insert
+// group referencing one shared LcNwcGeometry, as the gecko example does by
+// hand.
+//
+// Shapes are looked up by a hash of their values snapped to a grid much
+// coarser than the tolerance. Matching is best effort: a shape whose values
+// happen to sit either side of a grid line from an earlier match is kept as
+// a separate shape, although it is never merged with one that differs by
+// more than the tolerance.
+//
+// Add all geometry first, then create the nodes. Shapes that turn out to be
+// used once are created as plain geometry with no extra group.
+class GeometryInstancer
+{
+public:
+   GeometryInstancer(LtFloat tolerance = 1e-6);
+   ~GeometryInstancer();
+
+   // Registers geometry, returns an instance id for CreateNode.
+   LtInt32 Add(const GeometryRecorder& geometry);
+
+   // Node to add to the scene for an instance returned by Add.
+   LcNwcNode CreateNode(LtInt32 instance);
+
+   // Whether geometry used once is streamed relative to a local origin, see
+   // GeometryRecorder::ReplayRecentered. Shared shapes are always local.
+   void SetRecenter(bool recenter) { m_recenter = recenter; }
+
+   LtInt32 GetNumInstances() const { return LtInt32(m_instances.size()); }
+   LtInt32 GetNumShapes() const { return LtInt32(m_shapes.size()); }
+
+   // Fraction of instances that reused an existing shape
+   LtFloat GetDeduplicationRatio() const;
+
+   // "Instancing: N geometries, M unique shapes, P% deduplicated"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   GeometryInstancer(const GeometryInstancer&);
+   GeometryInstancer& operator= (const GeometryInstancer&);
+
+   struct Shape
+   {
+      GeometryRecorder* geometry;   // In canonical frame
+      LtInt32 num_uses;
+      LcNwcGeometry* node;          // Shared node, created on demand
+   };
+
+   struct Instance
+   {
+      LtInt32 shape;
+      LtFloat rotation[3][3];       // Canonical to world, rows are axes
+      LtVector offset;
+      bool rotated;
+   };
+
+   LtInt32 FindShape(LtNat64 hash, const GeometryRecorder& canonical) const;
+
+   LtFloat m_tolerance;
+   bool m_recenter;
+   GeometryArena m_arena;           // Storage for shapes
+   GeometryArena m_scratch_arena;   // Canonical form of geometry being added
+   std::vector<Shape> m_shapes;
+   std::vector<Instance> m_instances;
+   std::unordered_multimap<LtNat64, LtInt32> m_lookup;
+};
+
+#endif // GEOMETRYINSTANCER_HDR
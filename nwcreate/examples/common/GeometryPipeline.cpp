@@ -0,0 +1,141 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "GeometryPipeline.h"
+
+#include <thread>
+#include <vector>
+
+// Items in flight per worker thread when no window is given
+static const LtInt32 cITEMS_PER_THREAD = 4;
+
+GeometryPipeline::GeometryPipeline(LtInt32 num_threads, LtInt32 window)
+   : m_num_threads(num_threads), m_window(window), m_slots(0), m_slot_items(0),
+     m_num_items(0), m_next_build(0), m_next_submit(0), m_stopped(false),
+     m_build(0), m_user_data(0)
+{
+   if (m_num_threads <= 0)
+      m_num_threads = LtInt32(std::thread::hardware_concurrency());
+   if (m_num_threads <= 0)
+      m_num_threads = 1;
+
+   if (m_window <= 0)
+      m_window = m_num_threads * cITEMS_PER_THREAD;
+}
+
+GeometryPipeline::~GeometryPipeline()
+{
+}
+
+void
+GeometryPipeline::Worker()
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+
+   for (;;)
+   {
+      // Wait until there is an item to build and a free slot to build it in
+      while (!m_stopped && m_next_build < m_num_items &&
+             m_next_build >= m_next_submit + m_window)
+         m_space.wait(lock);
+
+      if (m_stopped || m_next_build >= m_num_items)
+         return;
+
+      LtInt32 item = m_next_build++;
+      GeometryRecorder& recorder = m_slots[item % m_window];
+
+      lock.unlock();
+      m_build(item, recorder, m_user_data);
+      lock.lock();
+
+      m_slot_items[item % m_window] = item;
+      m_built.notify_all();
+   }
+}
+
+bool
+GeometryPipeline::Run(LtInt32 num_items, BuildCallback build, SubmitCallback submit, void* user_data)
+{
+   // Not worth starting threads, build and submit in turn
+   if (m_num_threads == 1 || num_items <= 1)
+   {
+      GeometryRecorder recorder;
+      for (LtInt32 i = 0; i < num_items; i++)
+      {
+         recorder.Clear();
+         build(i, recorder, user_data);
+         if (!submit(i, recorder, user_data))
+            return false;
+      }
+      return true;
+   }
+
+   m_slots = new GeometryRecorder[m_window];
+   m_slot_items = new LtInt32[m_window];
+   for (LtInt32 i = 0; i < m_window; i++)
+      m_slot_items[i] = -1;
+
+   m_num_items = num_items;
+   m_next_build = 0;
+   m_next_submit = 0;
+   m_stopped = false;
+   m_build = build;
+   m_user_data = user_data;
+
+   LtInt32 num_workers = (m_num_threads < num_items) ? m_num_threads : num_items;
+   std::vector<std::thread> workers;
+   for (LtInt32 i = 0; i < num_workers; i++)
+      workers.push_back(std::thread(&GeometryPipeline::Worker, this));
+
+   bool ok = true;
+   for (LtInt32 item = 0; item < num_items && ok; item++)
+   {
+      LtInt32 slot = item % m_window;
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         while (m_slot_items[slot] != item)
+            m_built.wait(lock);
+      }
+
+      // Slot belongs to this thread until it is marked free
+      ok = submit(item, m_slots[slot], user_data);
+      m_slots[slot].Clear();
+
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_slot_items[slot] = -1;
+         m_next_submit = item + 1;
+         if (!ok)
+            m_stopped = true;
+      }
+      m_space.notify_all();
+   }
+
+   for (size_t i = 0; i < workers.size(); i++)
+      workers[i].join();
+
+   delete [] m_slots;
+   delete [] m_slot_items;
+   m_slots = 0;
+   m_slot_items = 0;
+
+   return ok;
+}
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef GEOMETRYPIPELINE_HDR
+#define GEOMETRYPIPELINE_HDR
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "GeometryRecorder.h"
+
+// Builds geometry for a numbered sequence of items on a pool of worker
+// threads and hands the results back on the calling thread in item order.
+//
+// The build callback runs on a worker and must not call the NWcreate API; it
+// records into a GeometryRecorder instead. The submit callback runs on the
+// thread that called Run, in increasing item order, and is where the
+// recorder is replayed into a geometry stream and the node added to the
+// scene. Output is the same whatever the number of threads.
+//
+// At most GetWindow items are built ahead of the next one to submit, which
+// bounds the memory held in recorders.
+class GeometryPipeline
+{
+public:
+   // Records geometry for item into recorder. Called on a worker thread.
+   typedef void (*BuildCallback)(LtInt32 item, GeometryRecorder& recorder, void* user_data);
+
+   // Consumes geometry for item. Called on the Run thread, in item order.
+   // Return false to stop the pipeline.
+   typedef bool (*SubmitCallback)(LtInt32 item, const GeometryRecorder& recorder, void* user_data);
+
+   // Zero threads means one per hardware thread. With one thread everything
+   // runs on the calling thread.
+   GeometryPipeline(LtInt32 num_threads = 0, LtInt32 window = 0);
+   ~GeometryPipeline();
+
+   // Returns false if a submit callback stopped the pipeline.
+   bool Run(LtInt32 num_items, BuildCallback build, SubmitCallback submit, void* user_data);
+
+   LtInt32 GetNumThreads() const { return m_num_threads; }
+   LtInt32 GetWindow() const { return m_window; }
+
+private:
+   // Can't copy
+   GeometryPipeline(const GeometryPipeline&);
+   GeometryPipeline& operator= (const GeometryPipeline&);
+
+   void Worker();
+
+   LtInt32 m_num_threads;
+   LtInt32 m_window;
+
+   // State for current Run, guarded by m_mutex
+   std::mutex m_mutex;
+   std::condition_variable m_built;    // A slot has been filled
+   std::condition_variable m_space;    // A slot has been freed
+   GeometryRecorder* m_slots;          // Item i is built in slot i % m_window
+   LtInt32* m_slot_items;              // Item held by each slot, -1 if none
+   LtInt32 m_num_items;
+   LtInt32 m_next_build;
+   LtInt32 m_next_submit;
+   bool m_stopped;
+   BuildCallback m_build;
+   void* m_user_data;
+};
+
+#endif // GEOMETRYPIPELINE_HDR
@@ -0,0 +1,1007 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "GeometryRecorder.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// One opcode per recorded stream method. Values are written to file so only
+// ever append new ones.
+enum RecorderOp
+{
+   eOP_CREASE_ANGLE,
+   eOP_SPLIT_THRESHOLD,
+   eOP_SPATIAL_SPLIT_THRESHOLD,
+   eOP_MERGE_THRESHOLD,
+   eOP_RECENTER_THRESHOLD,
+   eOP_FACETING_FACTOR,
+   eOP_MAX_FACET_DEVIATION,
+   eOP_EXTERIOR_FACETING,
+   eOP_CORRECT_GEN_NORMAL_ORIENTATION,
+   eOP_CORRECT_VERTEX_NORMAL_ORIENTATION,
+   eOP_PUSH_TRANSFORM,
+   eOP_POP_TRANSFORM,
+   eOP_SET_TRANSFORM_IDENTITY,
+   eOP_SET_TRANSFORM_TRANSLATION,
+   eOP_MULT_TRANSFORM_TRANSLATION,
+   eOP_SET_TRANSFORM,
+   eOP_MULT_TRANSFORM,
+   eOP_BEGIN,
+   eOP_END,
+   eOP_COLOR,
+   eOP_NORMAL,
+   eOP_TEX_COORD,
+   eOP_INDEXED_VERTEX,
+   eOP_INDEXED_LINE_VERTEX,
+   eOP_TRIANGLE_VERTEX,
+   eOP_TRIANGLE_INDEX,
+   eOP_TRI_STRIP_VERTEX,
+   eOP_TRI_STRIP_INDEX,
+   eOP_TRI_FAN_VERTEX,
+   eOP_TRI_FAN_INDEX,
+   eOP_CONVEX_POLY_VERTEX,
+   eOP_CONVEX_POLY_INDEX,
+   eOP_SEQ_END,
+   eOP_BEGIN_POLYGON,
+   eOP_BEGIN_POLYGON_CONTOUR,
+   eOP_POLYGON_VERTEX,
+   eOP_POLYGON_INDEX,
+   eOP_POLYGON_ELLIPSE,
+   eOP_END_POLYGON_CONTOUR,
+   eOP_END_POLYGON,
+   eOP_LINE_VERTEX,
+   eOP_LINE_INDEX,
+   eOP_LINE_STRIP_VERTEX,
+   eOP_LINE_STRIP_INDEX,
+   eOP_POINT,
+   eOP_SNAP_POINT,
+   eOP_CIRCLE,
+   eOP_ELLIPSE,
+   eOP_CYLINDER,
+   eOP_CONIC,
+   eOP_CUBOID,
+   eOP_SPHERE,
+   eOP_TORUS
+};
+
+static bool
+is_transform_op(LtNat8 op)
+{
+   return (op >= eOP_PUSH_TRANSFORM && op <= eOP_MULT_TRANSFORM);
+}
+
+// Number of values an opcode consumes from each column
+struct ColumnCounts
+{
+   size_t pos, dir, color, tex, ints, scalars;
+};
+
+// Adds the values consumed by op to counts. False for an unknown opcode.
+static bool
+count_op(LtNat8 op, ColumnCounts& counts)
+{
+   switch (op)
+   {
+   case eOP_PUSH_TRANSFORM:
+   case eOP_POP_TRANSFORM:
+   case eOP_SET_TRANSFORM_IDENTITY:
+   case eOP_END:
+   case eOP_SEQ_END:
+   case eOP_BEGIN_POLYGON:
+   case eOP_BEGIN_POLYGON_CONTOUR:
+   case eOP_END_POLYGON_CONTOUR:
+   case eOP_END_POLYGON:
+      break;
+
+   case eOP_SPLIT_THRESHOLD:
+   case eOP_SPATIAL_SPLIT_THRESHOLD:
+   case eOP_MERGE_THRESHOLD:
+   case eOP_EXTERIOR_FACETING:
+   case eOP_CORRECT_GEN_NORMAL_ORIENTATION:
+   case eOP_CORRECT_VERTEX_NORMAL_ORIENTATION:
+   case eOP_BEGIN:
+   case eOP_TRIANGLE_INDEX:
+   case eOP_TRI_STRIP_INDEX:
+   case eOP_TRI_FAN_INDEX:
+   case eOP_CONVEX_POLY_INDEX:
+   case eOP_POLYGON_INDEX:
+   case eOP_LINE_INDEX:
+   case eOP_LINE_STRIP_INDEX:
+      counts.ints++;
+      break;
+
+   case eOP_CREASE_ANGLE:
+   case eOP_RECENTER_THRESHOLD:
+   case eOP_FACETING_FACTOR:
+   case eOP_MAX_FACET_DEVIATION:
+      counts.scalars++;
+      break;
+
+   case eOP_SET_TRANSFORM:
+   case eOP_MULT_TRANSFORM:
+      counts.scalars += 16;
+      break;
+
+   case eOP_SET_TRANSFORM_TRANSLATION:
+   case eOP_MULT_TRANSFORM_TRANSLATION:
+   case eOP_NORMAL:
+      counts.dir++;
+      break;
+
+   case eOP_COLOR:
+      counts.color++;
+      break;
+
+   case eOP_TEX_COORD:
+      counts.tex++;
+      break;
+
+   case eOP_INDEXED_VERTEX:
+   case eOP_INDEXED_LINE_VERTEX:
+   case eOP_TRIANGLE_VERTEX:
+   case eOP_TRI_STRIP_VERTEX:
+   case eOP_TRI_FAN_VERTEX:
+   case eOP_CONVEX_POLY_VERTEX:
+   case eOP_POLYGON_VERTEX:
+   case eOP_LINE_VERTEX:
+   case eOP_LINE_STRIP_VERTEX:
+   case eOP_POINT:
+   case eOP_SNAP_POINT:
+      counts.pos++;
+      break;
+
+   case eOP_POLYGON_ELLIPSE:
+   case eOP_ELLIPSE:
+   case eOP_TORUS:
+      counts.pos++; counts.dir += 2; counts.scalars += 2;
+      break;
+
+   case eOP_CIRCLE:
+      counts.pos++; counts.dir++; counts.scalars++;
+      break;
+
+   case eOP_CYLINDER:
+      counts.pos += 2; counts.scalars++;
+      break;
+
+   case eOP_CONIC:
+      counts.pos += 2; counts.dir += 4; counts.scalars += 2;
+      break;
+
+   case eOP_CUBOID:
+      counts.pos += 2;
+      break;
+
+   case eOP_SPHERE:
+      counts.pos++; counts.scalars++;
+      break;
+
+   default:
+      return false;
+   }
+
+   return true;
+}
+
+static const LtNat32 cFILE_MAGIC = 0x5247574e;   // "NWGR"
+static const LtNat32 cFILE_VERSION = 1;
+
+GeometryRecorder::GeometryRecorder(GeometryArena* arena)
+   : m_arena(arena), m_own_arena(arena == 0), m_has_transforms(false),
+     m_axis_aligned(false), m_num_indexed(0), m_num_indexed_lines(0)
+{
+   if (m_own_arena)
+      m_arena = new GeometryArena;
+   Init();
+}
+
+GeometryRecorder::~GeometryRecorder()
+{
+   if (m_own_arena)
+      delete m_arena;
+}
+
+void
+GeometryRecorder::Init()
+{
+   m_op.SetArena(m_arena);
+   for (int i = 0; i < 3; i++)
+   {
+      m_pos[i].SetArena(m_arena);
+      m_dir[i].SetArena(m_arena);
+   }
+   for (int i = 0; i < 4; i++)
+      m_color[i].SetArena(m_arena);
+   for (int i = 0; i < 2; i++)
+      m_tex[i].SetArena(m_arena);
+   m_int.SetArena(m_arena);
+   m_scalar.SetArena(m_arena);
+}
+
+void
+GeometryRecorder::Clear()
+{
+   m_op.Clear();
+   for (int i = 0; i < 3; i++)
+   {
+      m_pos[i].Clear();
+      m_dir[i].Clear();
+   }
+   for (int i = 0; i < 4; i++)
+      m_color[i].Clear();
+   for (int i = 0; i < 2; i++)
+      m_tex[i].Clear();
+   m_int.Clear();
+   m_scalar.Clear();
+
+   m_has_transforms = false;
+   m_axis_aligned = false;
+   m_num_indexed = 0;
+   m_num_indexed_lines = 0;
+
+   if (m_own_arena)
+      m_arena->Reset();
+}
+
+//
+// Recording
+//
+
+void GeometryRecorder::CreaseAngle(LtFloat angle)
+{ Op(eOP_CREASE_ANGLE); m_scalar.PushBack(angle); }
+
+void GeometryRecorder::SplitThreshold(LtInt32 t)
+{ Op(eOP_SPLIT_THRESHOLD); m_int.PushBack(t); }
+
+void GeometryRecorder::SpatialSplitThreshold(LtInt32 t)
+{ Op(eOP_SPATIAL_SPLIT_THRESHOLD); m_int.PushBack(t); }
+
+void GeometryRecorder::MergeThreshold(LtInt32 t)
+{ Op(eOP_MERGE_THRESHOLD); m_int.PushBack(t); }
+
+void GeometryRecorder::RecenterThreshold(LtFloat dist)
+{ Op(eOP_RECENTER_THRESHOLD); m_scalar.PushBack(dist); }
+
+void GeometryRecorder::FacetingFactor(LtFloat factor)
+{ Op(eOP_FACETING_FACTOR); m_scalar.PushBack(factor); }
+
+void GeometryRecorder::MaxFacetDeviation(LtFloat tol)
+{ Op(eOP_MAX_FACET_DEVIATION); m_scalar.PushBack(tol); }
+
+void GeometryRecorder::ExteriorFaceting(bool b)
+{ Op(eOP_EXTERIOR_FACETING); m_int.PushBack(b ? 1 : 0); }
+
+void GeometryRecorder::CorrectGenNormalOrientation(bool enable)
+{ Op(eOP_CORRECT_GEN_NORMAL_ORIENTATION); m_int.PushBack(enable ? 1 : 0); }
+
+void GeometryRecorder::CorrectVertexNormalOrientation(bool enable)
+{ Op(eOP_CORRECT_VERTEX_NORMAL_ORIENTATION); m_int.PushBack(enable ? 1 : 0); }
+
+void GeometryRecorder::PushTransform()
+{ m_has_transforms = true; Op(eOP_PUSH_TRANSFORM); }
+
+void GeometryRecorder::PopTransform()
+{ m_has_transforms = true; Op(eOP_POP_TRANSFORM); }
+
+void GeometryRecorder::SetTransformIdentity()
+{ m_has_transforms = true; Op(eOP_SET_TRANSFORM_IDENTITY); }
+
+void GeometryRecorder::SetTransformTranslation(LtFloat x, LtFloat y, LtFloat z)
+{ m_has_transforms = true; Op(eOP_SET_TRANSFORM_TRANSLATION); Dir(x, y, z); }
+
+void GeometryRecorder::MultTransformTranslation(LtFloat x, LtFloat y, LtFloat z)
+{ m_has_transforms = true; Op(eOP_MULT_TRANSFORM_TRANSLATION); Dir(x, y, z); }
+
+void GeometryRecorder::SetTransform(const LtFloat matrix[16])
+{
+   m_has_transforms = true;
+   Op(eOP_SET_TRANSFORM);
+   for (int i = 0; i < 16; i++)
+      m_scalar.PushBack(matrix[i]);
+}
+
+void GeometryRecorder::MultTransform(const LtFloat matrix[16])
+{
+   m_has_transforms = true;
+   Op(eOP_MULT_TRANSFORM);
+   for (int i = 0; i < 16; i++)
+      m_scalar.PushBack(matrix[i]);
+}
+
+void GeometryRecorder::Begin(LtBitfield vertex_properties)
+{
+   Op(eOP_BEGIN);
+   m_int.PushBack(LtInt32(vertex_properties));
+   m_num_indexed = 0;
+   m_num_indexed_lines = 0;
+}
+
+void GeometryRecorder::End()
+{ Op(eOP_END); }
+
+void GeometryRecorder::Color(LtFloat r, LtFloat g, LtFloat b, LtFloat a)
+{ Op(eOP_COLOR); m_color[0].PushBack(r); m_color[1].PushBack(g); m_color[2].PushBack(b); m_color[3].PushBack(a); }
+
+void GeometryRecorder::Normal(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_NORMAL); Dir(x, y, z); }
+
+void GeometryRecorder::TexCoord(LtFloat u, LtFloat v)
+{ Op(eOP_TEX_COORD); m_tex[0].PushBack(u); m_tex[1].PushBack(v); }
+
+LtInt32 GeometryRecorder::IndexedVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_INDEXED_VERTEX); Pos(x, y, z); return m_num_indexed++; }
+
+LtInt32 GeometryRecorder::IndexedLineVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_INDEXED_LINE_VERTEX); Pos(x, y, z); return m_num_indexed_lines++; }
+
+void GeometryRecorder::TriangleVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_TRIANGLE_VERTEX); Pos(x, y, z); }
+
+void GeometryRecorder::TriangleIndex(LtInt32 index)
+{ Op(eOP_TRIANGLE_INDEX); m_int.PushBack(index); }
+
+void GeometryRecorder::TriStripVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_TRI_STRIP_VERTEX); Pos(x, y, z); }
+
+void GeometryRecorder::TriStripIndex(LtInt32 index)
+{ Op(eOP_TRI_STRIP_INDEX); m_int.PushBack(index); }
+
+void GeometryRecorder::TriFanVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_TRI_FAN_VERTEX); Pos(x, y, z); }
+
+void GeometryRecorder::TriFanIndex(LtInt32 index)
+{ Op(eOP_TRI_FAN_INDEX); m_int.PushBack(index); }
+
+void GeometryRecorder::ConvexPolyVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_CONVEX_POLY_VERTEX); Pos(x, y, z); }
+
+void GeometryRecorder::ConvexPolyIndex(LtInt32 index)
+{ Op(eOP_CONVEX_POLY_INDEX); m_int.PushBack(index); }
+
+void GeometryRecorder::SeqEnd()
+{ Op(eOP_SEQ_END); }
+
+void GeometryRecorder::BeginPolygon()
+{ Op(eOP_BEGIN_POLYGON); }
+
+void GeometryRecorder::BeginPolygonContour()
+{ Op(eOP_BEGIN_POLYGON_CONTOUR); }
+
+void GeometryRecorder::PolygonVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_POLYGON_VERTEX); Pos(x, y, z); }
+
+void GeometryRecorder::PolygonIndex(LtInt32 index)
+{ Op(eOP_POLYGON_INDEX); m_int.PushBack(index); }
+
+void GeometryRecorder::PolygonEllipse(const LtPoint center, const LtVector major,
+                                      const LtVector minor, LtFloat start_ang, LtFloat end_ang)
+{
+   Op(eOP_POLYGON_ELLIPSE);
+   Pos(center); Dir(major); Dir(minor);
+   m_scalar.PushBack(start_ang); m_scalar.PushBack(end_ang);
+}
+
+void GeometryRecorder::EndPolygonContour()
+{ Op(eOP_END_POLYGON_CONTOUR); }
+
+void GeometryRecorder::EndPolygon()
+{ Op(eOP_END_POLYGON); }
+
+void GeometryRecorder::LineVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_LINE_VERTEX); Pos(x, y, z); }
+
+void GeometryRecorder::LineIndex(LtInt32 index)
+{ Op(eOP_LINE_INDEX); m_int.PushBack(index); }
+
+void GeometryRecorder::LineStripVertex(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_LINE_STRIP_VERTEX); Pos(x, y, z); }
+
+void GeometryRecorder::LineStripIndex(LtInt32 index)
+{ Op(eOP_LINE_STRIP_INDEX); m_int.PushBack(index); }
+
+void GeometryRecorder::Point(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_POINT); Pos(x, y, z); }
+
+void GeometryRecorder::SnapPoint(LtFloat x, LtFloat y, LtFloat z)
+{ Op(eOP_SNAP_POINT); Pos(x, y, z); }
+
+void GeometryRecorder::Circle(const LtPoint center, const LtUnitVector normal, LtFloat radius)
+{ Op(eOP_CIRCLE); Pos(center); Dir(normal); m_scalar.PushBack(radius); }
+
+void GeometryRecorder::Ellipse(const LtPoint center, const LtVector major,
+                               const LtVector minor, LtFloat start_ang, LtFloat end_ang)
+{
+   Op(eOP_ELLIPSE);
+   Pos(center); Dir(major); Dir(minor);
+   m_scalar.PushBack(start_ang); m_scalar.PushBack(end_ang);
+}
+
+void GeometryRecorder::Cylinder(const LtPoint pt1, const LtPoint pt2, LtFloat radius)
+{ Op(eOP_CYLINDER); Pos(pt1); Pos(pt2); m_scalar.PushBack(radius); }
+
+void GeometryRecorder::Conic(const LtPoint pt1, const LtVector major1, const LtVector minor1,
+                             const LtPoint pt2, const LtVector major2, const LtVector minor2,
+                             LtFloat start_ang, LtFloat end_ang)
+{
+   Op(eOP_CONIC);
+   Pos(pt1); Dir(major1); Dir(minor1);
+   Pos(pt2); Dir(major2); Dir(minor2);
+   m_scalar.PushBack(start_ang); m_scalar.PushBack(end_ang);
+}
+
+void GeometryRecorder::Cuboid(const LtPoint pt1, const LtPoint pt2)
+{ m_axis_aligned = true; Op(eOP_CUBOID); Pos(pt1); Pos(pt2); }
+
+void GeometryRecorder::Sphere(const LtPoint pt, LtFloat radius)
+{ Op(eOP_SPHERE); Pos(pt); m_scalar.PushBack(radius); }
+
+void GeometryRecorder::Torus(const LtPoint center, const LtVector x_axis, const LtVector y_axis,
+                             LtFloat major_radius, LtFloat minor_radius)
+{
+   Op(eOP_TORUS);
+   Pos(center); Dir(x_axis); Dir(y_axis);
+   m_scalar.PushBack(major_radius); m_scalar.PushBack(minor_radius);
+}
+
+template <class T>
+static void
+append_column(ArenaColumn<T>& to, const ArenaColumn<T>& from)
+{
+   for (size_t i = 0; i < from.GetNumChunks(); i++)
+   {
+      const T* chunk = from.GetChunk(i);
+      size_t n = from.GetChunkSize(i);
+      for (size_t j = 0; j < n; j++)
+         to.PushBack(chunk[j]);
+   }
+}
+
+// Maps the three columns of source through rotation (and offset, if given)
+// into the three columns of dest.
+static void
+append_rotated(ArenaColumn<LtFloat> dest[3], const ArenaColumn<LtFloat> source[3],
+               const LtFloat rotation[3][3], const LtFloat* offset)
+{
+   ArenaColumnReader<LtFloat> x(source[0]), y(source[1]), z(source[2]);
+   size_t n = source[0].Size();
+
+   for (size_t i = 0; i < n; i++)
+   {
+      LtFloat v[3] = { x.Next(), y.Next(), z.Next() };
+      for (int k = 0; k < 3; k++)
+      {
+         LtFloat t = rotation[k][0] * v[0] + rotation[k][1] * v[1] + rotation[k][2] * v[2];
+         dest[k].PushBack(offset ? t + offset[k] : t);
+      }
+   }
+}
+
+void
+GeometryRecorder::AppendTransformed(const GeometryRecorder& source,
+                                    const LtFloat rotation[3][3],
+                                    const LtVector offset)
+{
+   size_t first_op = m_op.Size();
+   append_column(m_op, source.m_op);
+   append_rotated(m_pos, source.m_pos, rotation, offset);
+   append_rotated(m_dir, source.m_dir, rotation, 0);
+   for (int i = 0; i < 4; i++)
+      append_column(m_color[i], source.m_color[i]);
+   for (int i = 0; i < 2; i++)
+      append_column(m_tex[i], source.m_tex[i]);
+   append_column(m_int, source.m_int);
+   append_column(m_scalar, source.m_scalar);
+
+   Track(first_op);
+}
+
+void
+GeometryRecorder::Track(size_t first_op)
+{
+   for (size_t i = first_op; i < m_op.Size(); i++)
+   {
+      switch (m_op[i])
+      {
+      case eOP_BEGIN:
+         m_num_indexed = 0;
+         m_num_indexed_lines = 0;
+         break;
+      case eOP_INDEXED_VERTEX:
+         m_num_indexed++;
+         break;
+      case eOP_INDEXED_LINE_VERTEX:
+         m_num_indexed_lines++;
+         break;
+      case eOP_CUBOID:
+         m_axis_aligned = true;
+         break;
+      default:
+         if (is_transform_op(m_op[i]))
+            m_has_transforms = true;
+         break;
+      }
+   }
+}
+
+bool
+GeometryRecorder::IsConsistent() const
+{
+   ColumnCounts counts = { 0, 0, 0, 0, 0, 0 };
+   for (size_t i = 0; i < m_op.Size(); i++)
+   {
+      if (!count_op(m_op[i], counts))
+         return false;
+   }
+
+   for (int i = 0; i < 3; i++)
+   {
+      if (m_pos[i].Size() != counts.pos || m_dir[i].Size() != counts.dir)
+         return false;
+   }
+   for (int i = 0; i < 4; i++)
+   {
+      if (m_color[i].Size() != counts.color)
+         return false;
+   }
+   for (int i = 0; i < 2; i++)
+   {
+      if (m_tex[i].Size() != counts.tex)
+         return false;
+   }
+
+   return m_int.Size() == counts.ints && m_scalar.Size() == counts.scalars;
+}
+
+//
+// Bounds
+//
+
+bool
+GeometryRecorder::GetBounds(LtPoint min, LtPoint max) const
+{
+   size_t n = m_pos[0].Size();
+   if (n == 0)
+      return false;
+
+   for (int k = 0; k < 3; k++)
+   {
+      const ArenaColumn<LtFloat>& column = m_pos[k];
+      min[k] = max[k] = column[0];
+      for (size_t chunk = 0; chunk < column.GetNumChunks(); chunk++)
+      {
+         const LtFloat* values = column.GetChunk(chunk);
+         size_t size = column.GetChunkSize(chunk);
+         for (size_t i = 0; i < size; i++)
+         {
+            if (values[i] < min[k]) min[k] = values[i];
+            if (values[i] > max[k]) max[k] = values[i];
+         }
+      }
+   }
+   return true;
+}
+
+bool
+GeometryRecorder::GetLocalOrigin(LtVector origin) const
+{
+   origin[0] = origin[1] = origin[2] = 0;
+
+   // Recorded transforms may place positions in another frame
+   LtPoint min, max;
+   if (m_has_transforms || !GetBounds(min, max))
+      return false;
+
+   LtFloat diagonal = 0, distance = 0;
+   LtPoint center;
+   for (int k = 0; k < 3; k++)
+   {
+      center[k] = (min[k] + max[k]) / 2;
+      diagonal += (max[k] - min[k]) * (max[k] - min[k]);
+      distance += center[k] * center[k];
+   }
+   diagonal = sqrt(diagonal);
+   distance = sqrt(distance);
+
+   // Nothing to gain near the world origin
+   if (distance <= diagonal)
+      return false;
+
+   // Round to a power of two spacing no smaller than the geometry, so the
+   // origin is exact in single precision and neighbours tend to share it
+   LtFloat spacing = (diagonal > 0) ? pow(2.0, ceil(log(diagonal) / log(2.0))) : 1.0;
+   for (int k = 0; k < 3; k++)
+      origin[k] = floor(center[k] / spacing + 0.5) * spacing;
+
+   return origin[0] != 0 || origin[1] != 0 || origin[2] != 0;
+}
+
+//
+// Statistics
+//
+
+// Nominal facet counts for analytic primitives at default faceting
+static const LtInt32 cCURVE_FACETS = 16;
+static const LtInt32 cSURFACE_FACETS = 32;
+static const LtInt32 cSPHERE_FACETS = 224;
+static const LtInt32 cTORUS_FACETS = 512;
+
+LtInt32
+GeometryRecorder::GetNumPrimitives() const
+{
+   LtInt32 num_primitives = 0;
+   LtInt32 num_triangle_vertices = 0;
+   LtInt32 num_seq_vertices = 0;
+   LtInt32 num_polygon_vertices = 0;
+   LtInt32 num_contours = 0;
+
+   for (size_t i = 0; i < m_op.Size(); i++)
+   {
+      switch (m_op[i])
+      {
+         case eOP_TRIANGLE_VERTEX:
+         case eOP_TRIANGLE_INDEX:
+            num_triangle_vertices++;
+            break;
+         case eOP_TRI_STRIP_VERTEX:
+         case eOP_TRI_STRIP_INDEX:
+         case eOP_TRI_FAN_VERTEX:
+         case eOP_TRI_FAN_INDEX:
+         case eOP_CONVEX_POLY_VERTEX:
+         case eOP_CONVEX_POLY_INDEX:
+            num_seq_vertices++;
+            break;
+         case eOP_SEQ_END:
+            if (num_seq_vertices > 2)
+               num_primitives += num_seq_vertices - 2;
+            num_seq_vertices = 0;
+            break;
+         case eOP_POLYGON_VERTEX:
+         case eOP_POLYGON_INDEX:
+            num_polygon_vertices++;
+            break;
+         case eOP_POLYGON_ELLIPSE:
+            num_polygon_vertices += cCURVE_FACETS;
+            break;
+         case eOP_BEGIN_POLYGON_CONTOUR:
+            num_contours++;
+            break;
+         case eOP_END_POLYGON:
+            // Each hole adds two triangles to bridge it
+            if (num_polygon_vertices > 2)
+               num_primitives += num_polygon_vertices - 2 + 2 * (num_contours - 1);
+            num_polygon_vertices = 0;
+            num_contours = 0;
+            break;
+         case eOP_LINE_VERTEX:
+         case eOP_LINE_INDEX:
+         case eOP_LINE_STRIP_VERTEX:
+         case eOP_LINE_STRIP_INDEX:
+         case eOP_POINT:
+         case eOP_SNAP_POINT:
+            num_primitives++;
+            break;
+         case eOP_CIRCLE:
+         case eOP_ELLIPSE:
+            num_primitives += cCURVE_FACETS;
+            break;
+         case eOP_CYLINDER:
+         case eOP_CONIC:
+            num_primitives += cSURFACE_FACETS;
+            break;
+         case eOP_CUBOID:
+            num_primitives += 12;
+            break;
+         case eOP_SPHERE:
+            num_primitives += cSPHERE_FACETS;
+            break;
+         case eOP_TORUS:
+            num_primitives += cTORUS_FACETS;
+            break;
+      }
+   }
+
+   return num_primitives + num_triangle_vertices / 3;
+}
+
+//
+// Replay
+//
+
+// Readers for each column, consumed in step with the opcode stream.
+struct ReplayCursor
+{
+   ReplayCursor(const ArenaColumn<LtFloat> pos[3], const ArenaColumn<LtFloat> dir[3],
+                const LtVector origin)
+      : px(pos[0]), py(pos[1]), pz(pos[2]), dx(dir[0]), dy(dir[1]), dz(dir[2])
+   { ox = origin[0]; oy = origin[1]; oz = origin[2]; }
+
+   // Positions are made relative to origin in double precision
+   void Pos(LtPoint p) { p[0] = px.Next() - ox; p[1] = py.Next() - oy; p[2] = pz.Next() - oz; }
+   void Dir(LtVector v) { v[0] = dx.Next(); v[1] = dy.Next(); v[2] = dz.Next(); }
+
+   ArenaColumnReader<LtFloat> px, py, pz;
+   ArenaColumnReader<LtFloat> dx, dy, dz;
+   LtFloat ox, oy, oz;
+};
+
+void
+GeometryRecorder::Replay(LcNwcGeometryStream stream) const
+{
+   LtVector origin = { 0, 0, 0 };
+   Replay(stream, origin);
+}
+
+void
+GeometryRecorder::ReplayRecentered(LcNwcGeometryStream stream) const
+{
+   LtVector origin;
+   if (!GetLocalOrigin(origin))
+   {
+      Replay(stream);
+      return;
+   }
+
+   stream.PushTransform();
+   stream.MultTransformTranslation(origin);
+   Replay(stream, origin);
+   stream.PopTransform();
+}
+
+void
+GeometryRecorder::Replay(LcNwcGeometryStream stream, const LtVector origin) const
+{
+   ReplayCursor c(m_pos, m_dir, origin);
+   ArenaColumnReader<LtFloat> r(m_color[0]), g(m_color[1]), b(m_color[2]), a(m_color[3]);
+   ArenaColumnReader<LtFloat> u(m_tex[0]), v(m_tex[1]);
+   ArenaColumnReader<LtInt32> ints(m_int);
+   ArenaColumnReader<LtFloat> scalars(m_scalar);
+
+   LtPoint p1, p2;
+   LtVector v1, v2, v3, v4;
+   LtFloat s1, s2;
+   LtFloat matrix[16];
+
+   size_t num_chunks = m_op.GetNumChunks();
+   for (size_t chunk = 0; chunk < num_chunks; chunk++)
+   {
+      const LtNat8* ops = m_op.GetChunk(chunk);
+      size_t num_ops = m_op.GetChunkSize(chunk);
+
+      for (size_t i = 0; i < num_ops; i++)
+      {
+         switch (ops[i])
+         {
+         case eOP_CREASE_ANGLE: stream.CreaseAngle(scalars.Next()); break;
+         case eOP_SPLIT_THRESHOLD: stream.SplitThreshold(ints.Next()); break;
+         case eOP_SPATIAL_SPLIT_THRESHOLD: stream.SpatialSplitThreshold(ints.Next()); break;
+         case eOP_MERGE_THRESHOLD: stream.MergeThreshold(ints.Next()); break;
+         case eOP_RECENTER_THRESHOLD: stream.RecenterThreshold(scalars.Next()); break;
+         case eOP_FACETING_FACTOR: stream.FacetingFactor(scalars.Next()); break;
+         case eOP_MAX_FACET_DEVIATION: stream.MaxFacetDeviation(scalars.Next()); break;
+         case eOP_EXTERIOR_FACETING: stream.ExteriorFaceting(ints.Next() != 0); break;
+         case eOP_CORRECT_GEN_NORMAL_ORIENTATION: stream.CorrectGenNormalOrientation(ints.Next() != 0); break;
+         case eOP_CORRECT_VERTEX_NORMAL_ORIENTATION: stream.CorrectVertexNormalOrientation(ints.Next() != 0); break;
+
+         case eOP_PUSH_TRANSFORM: stream.PushTransform(); break;
+         case eOP_POP_TRANSFORM: stream.PopTransform(); break;
+         case eOP_SET_TRANSFORM_IDENTITY: stream.SetTransformIdentity(); break;
+         case eOP_SET_TRANSFORM_TRANSLATION: c.Dir(v1); stream.SetTransformTranslation(v1); break;
+         case eOP_MULT_TRANSFORM_TRANSLATION: c.Dir(v1); stream.MultTransformTranslation(v1); break;
+         case eOP_SET_TRANSFORM:
+            for (int k = 0; k < 16; k++)
+               matrix[k] = scalars.Next();
+            stream.SetTransform(matrix);
+            break;
+         case eOP_MULT_TRANSFORM:
+            for (int k = 0; k < 16; k++)
+               matrix[k] = scalars.Next();
+            stream.MultTransform(matrix);
+            break;
+
+         case eOP_BEGIN: stream.Begin(LtBitfield(ints.Next())); break;
+         case eOP_END: stream.End(); break;
+         case eOP_COLOR:
+            {
+               LtFloat cr = r.Next(), cg = g.Next(), cb = b.Next();
+               stream.Color(cr, cg, cb, a.Next());
+            }
+            break;
+         case eOP_NORMAL: c.Dir(v1); stream.Normal(v1); break;
+         case eOP_TEX_COORD: s1 = u.Next(); stream.TexCoord(s1, v.Next()); break;
+
+         case eOP_INDEXED_VERTEX: c.Pos(p1); stream.IndexedVertex(p1); break;
+         case eOP_INDEXED_LINE_VERTEX: c.Pos(p1); stream.IndexedLineVertex(p1); break;
+         case eOP_TRIANGLE_VERTEX: c.Pos(p1); stream.TriangleVertex(p1); break;
+         case eOP_TRIANGLE_INDEX: stream.TriangleIndex(ints.Next()); break;
+         case eOP_TRI_STRIP_VERTEX: c.Pos(p1); stream.TriStripVertex(p1); break;
+         case eOP_TRI_STRIP_INDEX: stream.TriStripIndex(ints.Next()); break;
+         case eOP_TRI_FAN_VERTEX: c.Pos(p1); stream.TriFanVertex(p1); break;
+         case eOP_TRI_FAN_INDEX: stream.TriFanIndex(ints.Next()); break;
+         case eOP_CONVEX_POLY_VERTEX: c.Pos(p1); stream.ConvexPolyVertex(p1); break;
+         case eOP_CONVEX_POLY_INDEX: stream.ConvexPolyIndex(ints.Next()); break;
+         case eOP_SEQ_END: stream.SeqEnd(); break;
+
+         case eOP_BEGIN_POLYGON: stream.BeginPolygon(); break;
+         case eOP_BEGIN_POLYGON_CONTOUR: stream.BeginPolygonContour(); break;
+         case eOP_POLYGON_VERTEX: c.Pos(p1); stream.PolygonVertex(p1); break;
+         case eOP_POLYGON_INDEX: stream.PolygonIndex(ints.Next()); break;
+         case eOP_POLYGON_ELLIPSE:
+            c.Pos(p1); c.Dir(v1); c.Dir(v2);
+            s1 = scalars.Next(); s2 = scalars.Next();
+            stream.PolygonEllipse(p1, v1, v2, s1, s2);
+            break;
+         case eOP_END_POLYGON_CONTOUR: stream.EndPolygonContour(); break;
+         case eOP_END_POLYGON: stream.EndPolygon(); break;
+
+         case eOP_LINE_VERTEX: c.Pos(p1); stream.LineVertex(p1); break;
+         case eOP_LINE_INDEX: stream.LineIndex(ints.Next()); break;
+         case eOP_LINE_STRIP_VERTEX: c.Pos(p1); stream.LineStripVertex(p1); break;
+         case eOP_LINE_STRIP_INDEX: stream.LineStripIndex(ints.Next()); break;
+         case eOP_POINT: c.Pos(p1); stream.Point(p1); break;
+         case eOP_SNAP_POINT: c.Pos(p1); stream.SnapPoint(p1); break;
+
+         case eOP_CIRCLE:
+            c.Pos(p1); c.Dir(v1);
+            stream.Circle(p1, v1, scalars.Next());
+            break;
+         case eOP_ELLIPSE:
+            c.Pos(p1); c.Dir(v1); c.Dir(v2);
+            s1 = scalars.Next(); s2 = scalars.Next();
+            stream.Ellipse(p1, v1, v2, s1, s2);
+            break;
+         case eOP_CYLINDER:
+            c.Pos(p1); c.Pos(p2);
+            stream.Cylinder(p1, p2, scalars.Next());
+            break;
+         case eOP_CONIC:
+            c.Pos(p1); c.Dir(v1); c.Dir(v2);
+            c.Pos(p2); c.Dir(v3); c.Dir(v4);
+            s1 = scalars.Next(); s2 = scalars.Next();
+            stream.Conic(p1, v1, v2, p2, v3, v4, s1, s2);
+            break;
+         case eOP_CUBOID:
+            c.Pos(p1); c.Pos(p2);
+            stream.Cuboid(p1, p2);
+            break;
+         case eOP_SPHERE:
+            c.Pos(p1);
+            stream.Sphere(p1, scalars.Next());
+            break;
+         case eOP_TORUS:
+            c.Pos(p1); c.Dir(v1); c.Dir(v2);
+            s1 = scalars.Next(); s2 = scalars.Next();
+            stream.Torus(p1, v1, v2, s1, s2);
+            break;
+         }
+      }
+   }
+}
+
+//
+// File IO
+//
+
+template <class T>
+static bool
+write_column(FILE* fp, const ArenaColumn<T>& column)
+{
+   LtNat64 size = column.Size();
+   if (fwrite(&size, sizeof(size), 1, fp) != 1)
+      return false;
+
+   for (size_t i = 0; i < column.GetNumChunks(); i++)
+   {
+      size_t n = column.GetChunkSize(i);
+      if (fwrite(column.GetChunk(i), sizeof(T), n, fp) != n)
+         return false;
+   }
+
+   return true;
+}
+
+template <class T>
+static bool
+read_column(FILE* fp, ArenaColumn<T>& column)
+{
+   LtNat64 size;
+   if (fread(&size, sizeof(size), 1, fp) != 1)
+      return false;
+
+   T buffer[256];
+   while (size > 0)
+   {
+      size_t n = (size > 256) ? 256 : size_t(size);
+      if (fread(buffer, sizeof(T), n, fp) != n)
+         return false;
+      for (size_t i = 0; i < n; i++)
+         column.PushBack(buffer[i]);
+      size -= n;
+   }
+
+   return true;
+}
+
+bool
+GeometryRecorder::WriteToFile(LtWideString pathname) const
+{
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"wb");
+   if (!fp)
+      return false;
+
+   bool ok = (fwrite(&cFILE_MAGIC, sizeof(cFILE_MAGIC), 1, fp) == 1 &&
+              fwrite(&cFILE_VERSION, sizeof(cFILE_VERSION), 1, fp) == 1 &&
+              write_column(fp, m_op));
+
+   for (int i = 0; ok && i < 3; i++)
+      ok = write_column(fp, m_pos[i]);
+   for (int i = 0; ok && i < 3; i++)
+      ok = write_column(fp, m_dir[i]);
+   for (int i = 0; ok && i < 4; i++)
+      ok = write_column(fp, m_color[i]);
+   for (int i = 0; ok && i < 2; i++)
+      ok = write_column(fp, m_tex[i]);
+
+   ok = ok && write_column(fp, m_int) && write_column(fp, m_scalar);
+
+   fclose(fp);
+   return ok;
+}
+
+bool
+GeometryRecorder::ReadFromFile(LtWideString pathname)
+{
+   Clear();
+
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"rb");
+   if (!fp)
+      return false;
+
+   LtNat32 magic = 0, version = 0;
+   bool ok = (fread(&magic, sizeof(magic), 1, fp) == 1 &&
+              fread(&version, sizeof(version), 1, fp) == 1 &&
+              magic == cFILE_MAGIC && version == cFILE_VERSION &&
+              read_column(fp, m_op));
+
+   for (int i = 0; ok && i < 3; i++)
+      ok = read_column(fp, m_pos[i]);
+   for (int i = 0; ok && i < 3; i++)
+      ok = read_column(fp, m_dir[i]);
+   for (int i = 0; ok && i < 4; i++)
+      ok = read_column(fp, m_color[i]);
+   for (int i = 0; ok && i < 2; i++)
+      ok = read_column(fp, m_tex[i]);
+
+   ok = ok && read_column(fp, m_int) && read_column(fp, m_scalar);
+
+   fclose(fp);
+
+   // Replay trusts the columns to hold what the opcodes consume
+   if (!ok || !IsConsistent())
+   {
+      Clear();
+      return false;
+   }
+
+   Track(0);
+   return true;
+}
@@ -0,0 +1,227 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef GEOMETRYRECORDER_HDR
+#define GEOMETRYRECORDER_HDR
+#pragma once
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "GeometryArena.h"
+
+// Records the calls made on a geometry stream into structure of arrays
+// columns, so that geometry can be built without an LcNwcGeometryStream (for
+// instance on a worker thread) and submitted later in one pass with Replay.
+//
+// The method names and arguments mirror LcNwcGeometryStream so that code
+// written against the stream can be templated on the stream type.
+//
+// Points (vertices, centers, end points) go in the position columns, normals
+// and other direction vectors in the direction columns, so that bounds can be
+// computed from positions alone. Analytic primitives are recorded, not
+// faceted.
+class GeometryRecorder
+{
+public:
+   // Arena is shared if supplied, otherwise the recorder has its own.
+   GeometryRecorder(GeometryArena* arena = 0);
+   ~GeometryRecorder();
+
+   // Forgets all recorded calls. A private arena is reset too.
+   void Clear();
+
+   // Stream settings
+   void CreaseAngle(LtFloat angle);
+   void SplitThreshold(LtInt32 t);
+   void SpatialSplitThreshold(LtInt32 t);
+   void MergeThreshold(LtInt32 t);
+   void RecenterThreshold(LtFloat dist);
+   void FacetingFactor(LtFloat factor);
+   void MaxFacetDeviation(LtFloat tol);
+   void ExteriorFaceting(bool b);
+   void CorrectGenNormalOrientation(bool enable);
+   void CorrectVertexNormalOrientation(bool enable);
+
+   // Transforms
+   void PushTransform();
+   void PopTransform();
+   void SetTransformIdentity();
+   void SetTransformTranslation(LtFloat x, LtFloat y, LtFloat z);
+   void SetTransformTranslation(const LtVector v)
+   { SetTransformTranslation(v[0], v[1], v[2]); }
+   void MultTransformTranslation(LtFloat x, LtFloat y, LtFloat z);
+   void MultTransformTranslation(const LtVector v)
+   { MultTransformTranslation(v[0], v[1], v[2]); }
+   void SetTransform(const LtFloat matrix[16]);
+   void MultTransform(const LtFloat matrix[16]);
+
+   // Vertex data
+   void Begin(LtBitfield vertex_properties);
+   void End();
+   void Color(LtFloat r, LtFloat g, LtFloat b, LtFloat a);
+   void Normal(LtFloat x, LtFloat y, LtFloat z);
+   void Normal(const LtVector v) { Normal(v[0], v[1], v[2]); }
+   void TexCoord(LtFloat u, LtFloat v);
+
+   LtInt32 IndexedVertex(LtFloat x, LtFloat y, LtFloat z);
+   LtInt32 IndexedVertex(const LtPoint p) { return IndexedVertex(p[0], p[1], p[2]); }
+   LtInt32 IndexedLineVertex(LtFloat x, LtFloat y, LtFloat z);
+   LtInt32 IndexedLineVertex(const LtPoint p) { return IndexedLineVertex(p[0], p[1], p[2]); }
+
+   void TriangleVertex(LtFloat x, LtFloat y, LtFloat z);
+   void TriangleVertex(const LtPoint p) { TriangleVertex(p[0], p[1], p[2]); }
+   void TriangleIndex(LtInt32 index);
+   void TriStripVertex(LtFloat x, LtFloat y, LtFloat z);
+   void TriStripVertex(const LtPoint p) { TriStripVertex(p[0], p[1], p[2]); }
+   void TriStripIndex(LtInt32 index);
+   void TriFanVertex(LtFloat x, LtFloat y, LtFloat z);
+   void TriFanVertex(const LtPoint p) { TriFanVertex(p[0], p[1], p[2]); }
+   void TriFanIndex(LtInt32 index);
+   void ConvexPolyVertex(LtFloat x, LtFloat y, LtFloat z);
+   void ConvexPolyVertex(const LtPoint p) { ConvexPolyVertex(p[0], p[1], p[2]); }
+   void ConvexPolyIndex(LtInt32 index);
+   void SeqEnd();
+
+   void BeginPolygon();
+   void BeginPolygonContour();
+   void PolygonVertex(LtFloat x, LtFloat y, LtFloat z);
+   void PolygonVertex(const LtPoint p) { PolygonVertex(p[0], p[1], p[2]); }
+   void PolygonIndex(LtInt32 index);
+   void PolygonEllipse(const LtPoint center, const LtVector major,
+      const LtVector minor, LtFloat start_ang=0, LtFloat end_ang=0);
+   void EndPolygonContour();
+   void EndPolygon();
+
+   void LineVertex(LtFloat x, LtFloat y, LtFloat z);
+   void LineVertex(const LtPoint p) { LineVertex(p[0], p[1], p[2]); }
+   void LineIndex(LtInt32 index);
+   void LineStripVertex(LtFloat x, LtFloat y, LtFloat z);
+   void LineStripVertex(const LtPoint p) { LineStripVertex(p[0], p[1], p[2]); }
+   void LineStripIndex(LtInt32 index);
+   void Point(LtFloat x, LtFloat y, LtFloat z);
+   void Point(const LtPoint p) { Point(p[0], p[1], p[2]); }
+   void SnapPoint(LtFloat x, LtFloat y, LtFloat z);
+   void SnapPoint(const LtPoint p) { SnapPoint(p[0], p[1], p[2]); }
+
+   // Analytic primitives
+   void Circle(const LtPoint center, const LtUnitVector normal, LtFloat radius);
+   void Ellipse(const LtPoint center, const LtVector major,
+      const LtVector minor, LtFloat start_ang=0, LtFloat end_ang=0);
+   void Cylinder(const LtPoint pt1, const LtPoint pt2, LtFloat radius);
+   void Conic(const LtPoint pt1, const LtVector major1, const LtVector minor1,
+      const LtPoint pt2, const LtVector major2, const LtVector minor2,
+      LtFloat start_ang=0, LtFloat end_ang=0);
+   void Cuboid(const LtPoint pt1, const LtPoint pt2);
+   void Sphere(const LtPoint pt, LtFloat radius);
+   void Torus(const LtPoint center, const LtVector x_axis, const LtVector y_axis,
+      LtFloat major_radius, LtFloat minor_radius);
+
+   // Issues every recorded call on stream, in order.
+   void Replay(LcNwcGeometryStream stream) const;
+
+   // As Replay, but with origin subtracted from every position in double
+   // precision. The caller is responsible for translating by origin.
+   void Replay(LcNwcGeometryStream stream, const LtVector origin) const;
+
+   // Replays geometry relative to GetLocalOrigin, inside a pushed
+   // MultTransformTranslation back to the origin. Geometry far from the world
+   // origin is then stored in single precision without losing detail.
+   void ReplayRecentered(LcNwcGeometryStream stream) const;
+
+   // Binary dump of the recorded columns. Read replaces current contents,
+   // and leaves the recorder empty if the file is unreadable or its columns
+   // don't match its opcodes.
+   bool WriteToFile(LtWideString pathname) const;
+   bool ReadFromFile(LtWideString pathname);
+
+   // Appends contents of source with every position mapped to
+   // rotation * p + offset and every direction to rotation * d. Only
+   // meaningful if source has no transform calls, and for a pure translation
+   // if source has axis aligned primitives.
+   void AppendTransformed(const GeometryRecorder& source,
+      const LtFloat rotation[3][3], const LtVector offset);
+
+   size_t GetNumCalls() const { return m_op.Size(); }
+
+   // Estimated number of triangles, lines and points the stream will end up
+   // with. Analytic primitives count as a nominal number of facets.
+   LtInt32 GetNumPrimitives() const;
+   size_t GetNumPositions() const { return m_pos[0].Size(); }
+   bool IsEmpty() const { return m_op.Size() == 0; }
+   bool HasTransforms() const { return m_has_transforms; }
+   bool HasAxisAlignedPrimitives() const { return m_axis_aligned; }
+
+   // Double precision bounds of recorded positions (vertices, centers and
+   // end points, not the extent of analytic primitives). False if empty.
+   bool GetBounds(LtPoint min, LtPoint max) const;
+
+   // Origin to stream geometry relative to. False, with a zero origin, if
+   // the geometry is no further from the world origin than its own size or
+   // if it has transform calls.
+   bool GetLocalOrigin(LtVector origin) const;
+
+   // Read access to the recorded columns
+   const ArenaColumn<LtNat8>& GetOps() const { return m_op; }
+   const ArenaColumn<LtFloat>& GetPositions(int axis) const { return m_pos[axis]; }
+   const ArenaColumn<LtFloat>& GetDirections(int axis) const { return m_dir[axis]; }
+   const ArenaColumn<LtFloat>& GetColors(int channel) const { return m_color[channel]; }
+   const ArenaColumn<LtFloat>& GetTexCoords(int axis) const { return m_tex[axis]; }
+   const ArenaColumn<LtInt32>& GetInts() const { return m_int; }
+   const ArenaColumn<LtFloat>& GetScalars() const { return m_scalar; }
+
+private:
+   // Can't copy
+   GeometryRecorder(const GeometryRecorder&);
+   GeometryRecorder& operator= (const GeometryRecorder&);
+
+   void Init();
+
+   // Updates flags and indexed vertex counts for the calls from first_op on
+   void Track(size_t first_op);
+
+   // True if every column holds exactly the values the opcodes consume
+   bool IsConsistent() const;
+   void Op(LtNat8 op) { m_op.PushBack(op); }
+   void Pos(LtFloat x, LtFloat y, LtFloat z)
+   { m_pos[0].PushBack(x); m_pos[1].PushBack(y); m_pos[2].PushBack(z); }
+   void Pos(const LtPoint p) { Pos(p[0], p[1], p[2]); }
+   void Dir(LtFloat x, LtFloat y, LtFloat z)
+   { m_dir[0].PushBack(x); m_dir[1].PushBack(y); m_dir[2].PushBack(z); }
+   void Dir(const LtVector v) { Dir(v[0], v[1], v[2]); }
+
+   GeometryArena* m_arena;
+   bool m_own_arena;
+   bool m_has_transforms;
+   bool m_axis_aligned;          // Contains Cuboid, can't be rotated
+
+   // Number of indexed vertices since last Begin, mirrors stream numbering
+   LtInt32 m_num_indexed;
+   LtInt32 m_num_indexed_lines;
+
+   ArenaColumn<LtNat8> m_op;
+   ArenaColumn<LtFloat> m_pos[3];
+   ArenaColumn<LtFloat> m_dir[3];
+   ArenaColumn<LtFloat> m_color[4];
+   ArenaColumn<LtFloat> m_tex[2];
+   ArenaColumn<LtInt32> m_int;
+   ArenaColumn<LtFloat> m_scalar;
+};
+
+#endif // GEOMETRYRECORDER_HDR
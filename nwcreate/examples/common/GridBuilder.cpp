@@ -0,0 +1,189 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "GridBuilder.h"
+
+#include <wchar.h>
+#include <algorithm>
+#include <functional>
+
+GridBuilder::GridBuilder(LtFloat tolerance, LtInt32 max_levels)
+   : m_tolerance(tolerance),
+     m_max_levels(max_levels),
+     m_num_levels_built(0)
+{
+}
+
+LtInt32
+GridBuilder::AddLabel(LtWideString label)
+{
+   // Few distinct labels, most recent first
+   for (size_t i = m_labels.size(); i-- > 0; )
+   {
+      if (m_labels[i] == label)
+         return LtInt32(i);
+   }
+   m_labels.push_back(label);
+   return LtInt32(m_labels.size() - 1);
+}
+
+void
+GridBuilder::AddLevel(LtFloat elevation, LtWideString label)
+{
+   Level level = { elevation, AddLabel(label) };
+   m_levels.push_back(level);
+}
+
+void
+GridBuilder::AddLevels(LtInt32 num_levels, const LtFloat* elevations, LtWideString label)
+{
+   LtInt32 id = AddLabel(label);
+   m_levels.reserve(m_levels.size() + num_levels);
+   for (LtInt32 i = 0; i < num_levels; i++)
+   {
+      Level level = { elevations[i], id };
+      m_levels.push_back(level);
+   }
+}
+
+void
+GridBuilder::AddLine(LtWideString label, const LtPoint start, const LtPoint end)
+{
+   Line line;
+   line.label = AddLabel(label);
+   for (int k = 0; k < 3; k++)
+   {
+      line.start[k] = start[k];
+      line.end[k] = end[k];
+   }
+   m_lines.push_back(line);
+}
+
+void
+GridBuilder::AddLines(LtInt32 num_lines, const LtWideString* labels,
+                      const LtPoint* starts, const LtPoint* ends)
+{
+   m_lines.reserve(m_lines.size() + num_lines);
+   for (LtInt32 i = 0; i < num_lines; i++)
+      AddLine(labels[i], starts[i], ends[i]);
+}
+
+void
+GridBuilder::Cluster(const std::vector<LtFloat>& sorted, LtFloat tolerance, LtInt32 max_runs,
+                     std::vector<size_t>& runs)
+{
+   // Runs are measured from their first value, so they can't chain
+   // together into one wide run
+   runs.clear();
+   for (size_t i = 0; i < sorted.size(); i++)
+   {
+      if (runs.empty() || sorted[i] - sorted[runs.back()] > tolerance)
+         runs.push_back(i);
+   }
+
+   // Too many: keep the max_runs - 1 widest gaps between runs
+   if (max_runs > 0 && runs.size() > size_t(max_runs))
+   {
+      std::vector<std::pair<LtFloat, size_t> > gaps;
+      gaps.reserve(runs.size() - 1);
+      for (size_t r = 1; r < runs.size(); r++)
+         gaps.push_back(std::make_pair(sorted[runs[r]] - sorted[runs[r] - 1], runs[r]));
+
+      std::nth_element(gaps.begin(), gaps.begin() + (max_runs - 1), gaps.end(),
+                       std::greater<std::pair<LtFloat, size_t> >());
+
+      runs.assign(1, 0);
+      for (LtInt32 g = 0; g < max_runs - 1; g++)
+         runs.push_back(gaps[g].second);
+      std::sort(runs.begin(), runs.end());
+   }
+
+   runs.push_back(sorted.size());
+}
+
+LtInt32
+GridBuilder::AddTo(LcNwcGridSystem system) const
+{
+   for (size_t i = 0; i < m_lines.size(); i++)
+   {
+      const Line& line = m_lines[i];
+      LcNwcGridLine grid_line(m_labels[line.label].c_str());
+      grid_line.AddLinearSegment(const_cast<LtFloat*>(line.start), const_cast<LtFloat*>(line.end));
+      system.AddGridLine(grid_line);
+   }
+
+   // Levels of each label, sorted by elevation
+   std::vector<Level> levels(m_levels);
+   std::sort(levels.begin(), levels.end(), [](const Level& a, const Level& b)
+   {
+      return (a.label != b.label) ? a.label < b.label : a.elevation < b.elevation;
+   });
+
+   LtInt32 num_added = 0;
+   std::vector<LtFloat> elevations;
+   std::vector<size_t> runs;
+   for (size_t first = 0; first < levels.size(); )
+   {
+      size_t last = first;
+      while (last < levels.size() && levels[last].label == levels[first].label)
+         last++;
+
+      elevations.clear();
+      for (size_t i = first; i < last; i++)
+         elevations.push_back(levels[i].elevation);
+      Cluster(elevations, m_tolerance, m_max_levels, runs);
+
+      const std::wstring& label = m_labels[levels[first].label];
+      for (size_t r = 0; r + 1 < runs.size(); r++)
+      {
+         LtFloat sum = 0;
+         for (size_t i = runs[r]; i < runs[r + 1]; i++)
+            sum += elevations[i];
+
+         LcNwcGridLevel level(label.c_str(), sum / (runs[r + 1] - runs[r]));
+         system.AddGridLevel(level);
+         num_added++;
+      }
+
+      first = last;
+   }
+
+   m_num_levels_built = num_added;
+   return num_added;
+}
+
+void
+GridBuilder::Clear()
+{
+   m_labels.clear();
+   m_levels.clear();
+   m_lines.clear();
+   m_num_levels_built = 0;
+}
+
+std::wstring
+GridBuilder::GetStatistics() const
+{
+   wchar_t buffer[128];
+   swprintf(buffer, 128, L"Grid: %d levels from %d, %d lines",
+            m_num_levels_built, GetNumLevelsAdded(), GetNumLines());
+   return buffer;
+}
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef GRIDBUILDER_HDR
+#define GRIDBUILDER_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Collects the levels and lines of a grid system and adds them in one go.
+//
+// Levels can be added once per element, say at the top of every column.
+// AddTo sorts the levels of each label and merges those within tolerance of
+// the lowest level of a run into one level at their mean elevation, so the
+// grid gets a level per distinct elevation rather than per element. If that
+// still leaves more than max_levels for a label, the closest neighbouring
+// levels are merged as well. Lines are added singly or in bulk from tables.
+class GridBuilder
+{
+public:
+   // Zero max_levels for no limit
+   GridBuilder(LtFloat tolerance = 1e-3, LtInt32 max_levels = 0);
+
+   void AddLevel(LtFloat elevation, LtWideString label);
+   void AddLevels(LtInt32 num_levels, const LtFloat* elevations, LtWideString label);
+
+   void AddLine(LtWideString label, const LtPoint start, const LtPoint end);
+   void AddLines(LtInt32 num_lines, const LtWideString* labels,
+                 const LtPoint* starts, const LtPoint* ends);
+
+   LtInt32 GetNumLevelsAdded() const { return LtInt32(m_levels.size()); }
+   LtInt32 GetNumLines() const { return LtInt32(m_lines.size()); }
+
+   // Merges levels and adds everything to system. Returns the number of
+   // levels added.
+   LtInt32 AddTo(LcNwcGridSystem system) const;
+
+   void Clear();
+
+   // "Grid: N levels from M, L lines"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   GridBuilder(const GridBuilder&);
+   GridBuilder& operator= (const GridBuilder&);
+
+   struct Level
+   {
+      LtFloat elevation;
+      LtInt32 label;
+   };
+
+   struct Line
+   {
+      LtInt32 label;
+      LtPoint start;
+      LtPoint end;
+   };
+
+   LtInt32 AddLabel(LtWideString label);
+
+   // Start of each run of sorted values to merge, ending with values.size()
+   static void Cluster(const std::vector<LtFloat>& sorted, LtFloat tolerance, LtInt32 max_runs,
+                       std::vector<size_t>& runs);
+
+   LtFloat m_tolerance;
+   LtInt32 m_max_levels;
+   std::vector<std::wstring> m_labels;
+   std::vector<Level> m_levels;
+   std::vector<Line> m_lines;
+   mutable LtInt32 m_num_levels_built;
+};
+
+#endif // GRIDBUILDER_HDR
@@ -0,0 +1,239 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "GuidBatch.h"
+
+#include <string.h>
+
+GuidBatch::GuidBatch(LtNwcGuid name_space)
+   : m_name_space(name_space ? LiNwcGuidCreateCopy(name_space) : NULL)
+{
+}
+
+GuidBatch::~GuidBatch()
+{
+   Clear();
+   if (m_name_space)
+      LiNwcGuidDestroy(m_name_space);
+}
+
+LtNwcGuid
+GuidBatch::Own(LtNwcGuid guid)
+{
+   if (guid)
+      m_owned.push_back(guid);
+   return guid;
+}
+
+LtNwcGuid
+GuidBatch::AddNat64Hash(LtNat64 id)
+{
+   LtNwcGuid& guid = m_nat64_cache[id];
+   if (!guid)
+      guid = Own(LiNwcGuidCreateFromNat64Hash(m_name_space, id));
+   m_guids.push_back(guid);
+   return guid;
+}
+
+LtNwcGuid
+GuidBatch::AddStringHash(LtString id)
+{
+   LtNwcGuid& guid = m_string_cache[id];
+   if (!guid)
+      guid = Own(LiNwcGuidCreateFromStringHash(m_name_space, id));
+   m_guids.push_back(guid);
+   return guid;
+}
+
+LtNwcGuid
+GuidBatch::AddWideStringHash(LtWideString id)
+{
+   LtNwcGuid& guid = m_wide_string_cache[id];
+   if (!guid)
+      guid = Own(LiNwcGuidCreateFromWideStringHash(m_name_space, id));
+   m_guids.push_back(guid);
+   return guid;
+}
+
+LtNwcGuid
+GuidBatch::AddGuidString(LtWideString str)
+{
+   LtNat32 data1;
+   LtNat16 data2, data3;
+   LtNat8 data4[8];
+
+   LtNwcGuid guid;
+   if (ParseGuidString(str, data1, data2, data3, data4))
+      guid = LiNwcGuidCreateFromRawData(data1, data2, data3, data4);
+   else
+      guid = LiNwcGuidCreateFromGuidString(str);
+
+   m_guids.push_back(Own(guid));
+   return guid;
+}
+
+LtNwcGuid
+GuidBatch::AddRawGuid(const LtNat8 data[16])
+{
+   LtNat32 data1;
+   LtNat16 data2, data3;
+   LtNat8 data4[8];
+   memcpy(&data1, data, 4);
+   memcpy(&data2, data + 4, 2);
+   memcpy(&data3, data + 6, 2);
+   memcpy(data4, data + 8, 8);
+
+   LtNwcGuid guid = LiNwcGuidCreateFromRawData(data1, data2, data3, data4);
+   m_guids.push_back(Own(guid));
+   return guid;
+}
+
+void
+GuidBatch::AddNat64Hashes(const LtNat64* ids, size_t num)
+{
+   m_guids.reserve(m_guids.size() + num);
+   for (size_t i = 0; i < num; i++)
+      AddNat64Hash(ids[i]);
+}
+
+void
+GuidBatch::AddStringHashes(const LtString* ids, size_t num)
+{
+   m_guids.reserve(m_guids.size() + num);
+   for (size_t i = 0; i < num; i++)
+      AddStringHash(ids[i]);
+}
+
+void
+GuidBatch::AddWideStringHashes(const LtWideString* ids, size_t num)
+{
+   m_guids.reserve(m_guids.size() + num);
+   for (size_t i = 0; i < num; i++)
+      AddWideStringHash(ids[i]);
+}
+
+void
+GuidBatch::AddGuidStrings(const LtWideString* guids, size_t num)
+{
+   m_guids.reserve(m_guids.size() + num);
+   m_owned.reserve(m_owned.size() + num);
+   for (size_t i = 0; i < num; i++)
+      AddGuidString(guids[i]);
+}
+
+void
+GuidBatch::AddRawGuids(const LtNat8* data, size_t num)
+{
+   m_guids.reserve(m_guids.size() + num);
+   m_owned.reserve(m_owned.size() + num);
+   for (size_t i = 0; i < num; i++)
+      AddRawGuid(data + i * 16);
+}
+
+void
+GuidBatch::Clear()
+{
+   for (size_t i = 0; i < m_owned.size(); i++)
+      LiNwcGuidDestroy(m_owned[i]);
+
+   m_owned.clear();
+   m_guids.clear();
+   m_nat64_cache.clear();
+   m_string_cache.clear();
+   m_wide_string_cache.clear();
+}
+
+// Value of hex digit, -1 if not one
+static int
+hex_digit(wchar_t c)
+{
+   if (c >= L'0' && c <= L'9')
+      return c - L'0';
+   if (c >= L'a' && c <= L'f')
+      return c - L'a' + 10;
+   if (c >= L'A' && c <= L'F')
+      return c - L'A' + 10;
+   return -1;
+}
+
+// Reads num_digits hex digits from str
+static bool
+read_hex(LtWideString& str, int num_digits, LtNat32& value)
+{
+   value = 0;
+   for (int i = 0; i < num_digits; i++)
+   {
+      int digit = hex_digit(*str++);
+      if (digit < 0)
+         return false;
+      value = (value << 4) | LtNat32(digit);
+   }
+   return true;
+}
+
+bool
+GuidBatch::ParseGuidString(LtWideString guid, LtNat32& data1, LtNat16& data2,
+                           LtNat16& data3, LtNat8 data4[8])
+{
+   if (!guid)
+      return false;
+
+   bool braces = (*guid == L'{');
+   if (braces)
+      guid++;
+
+   LtNat32 value;
+   if (!read_hex(guid, 8, data1) || *guid++ != L'-')
+      return false;
+   if (!read_hex(guid, 4, value) || *guid++ != L'-')
+      return false;
+   data2 = LtNat16(value);
+   if (!read_hex(guid, 4, value) || *guid++ != L'-')
+      return false;
+   data3 = LtNat16(value);
+
+   for (int i = 0; i < 8; i++)
+   {
+      if (i == 2 && *guid++ != L'-')
+         return false;
+      if (!read_hex(guid, 2, value))
+         return false;
+      data4[i] = LtNat8(value);
+   }
+
+   if (braces && *guid++ != L'}')
+      return false;
+   return *guid == 0;
+}
+
+bool
+GuidBatch::ParseGuidString(LtWideString guid, LtNat8 data[16])
+{
+   LtNat32 data1;
+   LtNat16 data2, data3;
+   if (!ParseGuidString(guid, data1, data2, data3, data + 8))
+      return false;
+
+   memcpy(data, &data1, 4);
+   memcpy(data + 4, &data2, 2);
+   memcpy(data + 6, &data3, 2);
+   return true;
+}
@@ -0,0 +1,95 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef GUIDBATCH_HDR
+#define GUIDBATCH_HDR
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Creates the GUIDs for a batch of items from their native ids and owns
+// them until the batch is cleared.
+//
+// Hashed GUIDs come from the LiNwcGuidCreateFrom...Hash functions
+// themselves, so they match GUIDs already written by other converters.
+// Each distinct id is hashed once per batch however many items share it.
+// GUID strings in the usual 8-4-4-4-12 form, with or without braces, are
+// parsed here into raw data; anything else goes to
+// LiNwcGuidCreateFromGuidString.
+class GuidBatch
+{
+public:
+   // Name space passed to the hash functions for hashed GUIDs. It is
+   // copied.
+   GuidBatch(LtNwcGuid name_space = NULL);
+   ~GuidBatch();
+
+   // Append GUIDs for ids. Each returns the GUID of its id, owned by the
+   // batch.
+   LtNwcGuid AddNat64Hash(LtNat64 id);
+   LtNwcGuid AddStringHash(LtString id);
+   LtNwcGuid AddWideStringHash(LtWideString id);
+   LtNwcGuid AddGuidString(LtWideString guid);
+
+   // GUID of 16 bytes laid out as a Windows GUID in memory, as read from a
+   // binary file, passed straight to LiNwcGuidCreateFromRawData.
+   LtNwcGuid AddRawGuid(const LtNat8 data[16]);
+
+   void AddNat64Hashes(const LtNat64* ids, size_t num);
+   void AddStringHashes(const LtString* ids, size_t num);
+   void AddWideStringHashes(const LtWideString* ids, size_t num);
+   void AddGuidStrings(const LtWideString* guids, size_t num);
+   void AddRawGuids(const LtNat8* data, size_t num);
+
+   // GUID of the i'th id added, NULL if it couldn't be made
+   size_t GetSize() const { return m_guids.size(); }
+   LtNwcGuid Get(size_t i) const { return m_guids[i]; }
+
+   // Destroys all GUIDs. Keeps the name space.
+   void Clear();
+
+   LtInt32 GetNumCreated() const { return LtInt32(m_owned.size()); }
+
+   // Parses a GUID string into raw data. False if not in 8-4-4-4-12 form.
+   static bool ParseGuidString(LtWideString guid, LtNat32& data1, LtNat16& data2,
+                               LtNat16& data3, LtNat8 data4[8]);
+   static bool ParseGuidString(LtWideString guid, LtNat8 data[16]);
+
+private:
+   // Can't copy
+   GuidBatch(const GuidBatch&);
+   GuidBatch& operator= (const GuidBatch&);
+
+   LtNwcGuid Own(LtNwcGuid guid);
+
+   LtNwcGuid m_name_space;
+   std::vector<LtNwcGuid> m_guids;     // Per id, may repeat
+   std::vector<LtNwcGuid> m_owned;     // Each created GUID once
+   std::unordered_map<LtNat64, LtNwcGuid> m_nat64_cache;
+   std::unordered_map<std::string, LtNwcGuid> m_string_cache;
+   std::unordered_map<std::wstring, LtNwcGuid> m_wide_string_cache;
+};
+
+#endif // GUIDBATCH_HDR
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "MappedFile.h"
+
+#include <windows.h>
+
+bool
+FileStamp::Get(LtWideString pathname, FileStamp& stamp)
+{
+   WIN32_FILE_ATTRIBUTE_DATA data;
+   if (!GetFileAttributesExW(pathname, GetFileExInfoStandard, &data))
+      return false;
+
+   stamp.size = (LtInt64(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+   stamp.write_time = (LtInt64(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                      data.ftLastWriteTime.dwLowDateTime;
+   return true;
+}
+
+MappedFile::MappedFile()
+   : m_file(0),
+     m_mapping(0),
+     m_data(0),
+     m_size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+   Close();
+}
+
+bool
+MappedFile::Open(LtWideString pathname)
+{
+   Close();
+
+   HANDLE file = CreateFileW(pathname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+   if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+   LARGE_INTEGER size;
+   if (!GetFileSizeEx(file, &size))
+   {
+      CloseHandle(file);
+      return false;
+   }
+
+   m_file = file;
+   m_size = size_t(size.QuadPart);
+
+   // Can't map an empty file
+   if (m_size == 0)
+      return true;
+
+   m_mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+   if (m_mapping)
+      m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+   if (!m_data)
+   {
+      Close();
+      return false;
+   }
+
+   return true;
+}
+
+void
+MappedFile::Close()
+{
+   if (m_data)
+      UnmapViewOfFile(m_data);
+   if (m_mapping)
+      CloseHandle(m_mapping);
+   if (m_file)
+      CloseHandle(m_file);
+
+   m_file = 0;
+   m_mapping = 0;
+   m_data = 0;
+   m_size = 0;
+}
@@ -0,0 +1,72 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef MAPPEDFILE_HDR
+#define MAPPEDFILE_HDR
+#pragma once
+
+#include <stddef.h>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Size and last write time of a file, to tell whether it has changed
+struct FileStamp
+{
+   LtInt64 size;
+   LtInt64 write_time;
+
+   // False if the file doesn't exist
+   static bool Get(LtWideString pathname, FileStamp& stamp);
+
+   bool operator== (const FileStamp& other) const
+   { return size == other.size && write_time == other.write_time; }
+};
+
+// Read only view of a whole file mapped into memory. Pages are read by the
+// system as they are touched, so parsing reads straight from the file
+// cache without copying into stream buffers.
+class MappedFile
+{
+public:
+   MappedFile();
+   ~MappedFile();
+
+   // False if the file can't be opened or mapped. An empty file opens with
+   // no data.
+   bool Open(LtWideString pathname);
+   void Close();
+
+   bool IsOpen() const { return m_file != 0; }
+   const char* GetData() const { return m_data; }
+   size_t GetSize() const { return m_size; }
+
+private:
+   // Can't copy
+   MappedFile(const MappedFile&);
+   MappedFile& operator= (const MappedFile&);
+
+   void* m_file;                       // HANDLE
+   void* m_mapping;                    // HANDLE, NULL for an empty file
+   const char* m_data;
+   size_t m_size;
+};
+
+#endif // MAPPEDFILE_HDR
@@ -0,0 +1,132 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "MaterialPool.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+MaterialSpec::MaterialSpec()
+   : m_set(0)
+{
+   memset(m_values, 0, sizeof(m_values));
+}
+
+void
+MaterialSpec::Set(Component c, LtFloat x, LtFloat y, LtFloat z)
+{
+   m_values[c][0] = x;
+   m_values[c][1] = y;
+   m_values[c][2] = z;
+   m_set |= 1 << c;
+}
+
+bool
+MaterialPool::Key::operator== (const Key& other) const
+{
+   return memcmp(values, other.values, sizeof(values)) == 0;
+}
+
+size_t
+MaterialPool::KeyHash::operator() (const Key& key) const
+{
+   // FNV-1a over the quantized values
+   LtNat64 hash = 0xcbf29ce484222325ULL;
+   for (int i = 0; i < cKEY_SIZE; i++)
+   {
+      hash ^= LtNat64(key.values[i]);
+      hash *= 0x100000001b3ULL;
+   }
+   return size_t(hash);
+}
+
+MaterialPool::MaterialPool(LtFloat tolerance)
+   : m_tolerance(tolerance)
+   , m_num_requested(0)
+{
+}
+
+LcNwcMaterial
+MaterialPool::Get(const MaterialSpec& spec)
+{
+   m_num_requested++;
+
+   Key key;
+   key.values[0] = spec.m_set;
+   for (int c = 0; c < MaterialSpec::eNUM_COMPONENTS; c++)
+   {
+      for (int i = 0; i < 3; i++)
+      {
+         LtFloat value = (spec.m_set & (1 << c)) ? spec.m_values[c][i] : 0;
+         key.values[1 + c * 3 + i] = LtInt64(floor(value / m_tolerance + 0.5));
+      }
+   }
+
+   std::unordered_map<Key, LcNwcMaterial, KeyHash>::iterator it = m_materials.find(key);
+   if (it != m_materials.end())
+      return it->second;
+
+   LcNwcMaterial material;
+   const LtFloat* v;
+   if (spec.Get(MaterialSpec::eDIFFUSE, v))
+      material.SetDiffuseColor(v[0], v[1], v[2]);
+   if (spec.Get(MaterialSpec::eAMBIENT, v))
+      material.SetAmbientColor(v[0], v[1], v[2]);
+   if (spec.Get(MaterialSpec::eSPECULAR, v))
+      material.SetSpecularColor(v[0], v[1], v[2]);
+   if (spec.Get(MaterialSpec::eEMISSIVE, v))
+      material.SetEmissiveColor(v[0], v[1], v[2]);
+   if (spec.Get(MaterialSpec::eSHININESS, v))
+      material.SetShininess(v[0]);
+   if (spec.Get(MaterialSpec::eTRANSPARENCY, v))
+      material.SetTransparency(v[0]);
+
+   m_materials.insert(std::make_pair(key, material));
+   return material;
+}
+
+LcNwcMaterial
+MaterialPool::GetColor(LtFloat r, LtFloat g, LtFloat b, LtFloat transparency)
+{
+   MaterialSpec spec;
+   spec.SetDiffuseColor(r, g, b);
+   spec.SetAmbientColor(r, g, b);
+   if (transparency != 0)
+      spec.SetTransparency(transparency);
+   return Get(spec);
+}
+
+void
+MaterialPool::Clear()
+{
+   m_materials.clear();
+   m_num_requested = 0;
+}
+
+std::wstring
+MaterialPool::GetStatistics() const
+{
+   wchar_t buffer[128];
+   swprintf(buffer, 128, L"Materials: %d requested, %d unique",
+            m_num_requested, GetNumUnique());
+   return buffer;
+}
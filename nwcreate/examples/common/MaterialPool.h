@@ -0,0 +1,115 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef MATERIALPOOL_HDR
+#define MATERIALPOOL_HDR
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Full state of a material, set with the same methods as LcNwcMaterial.
+// Components that aren't set keep the NavisWorks default.
+class MaterialSpec
+{
+public:
+   MaterialSpec();
+
+   void SetDiffuseColor(LtFloat r, LtFloat g, LtFloat b) { Set(eDIFFUSE, r, g, b); }
+   void SetAmbientColor(LtFloat r, LtFloat g, LtFloat b) { Set(eAMBIENT, r, g, b); }
+   void SetSpecularColor(LtFloat r, LtFloat g, LtFloat b) { Set(eSPECULAR, r, g, b); }
+   void SetEmissiveColor(LtFloat r, LtFloat g, LtFloat b) { Set(eEMISSIVE, r, g, b); }
+   void SetShininess(LtFloat t) { Set(eSHININESS, t, 0, 0); }
+   void SetTransparency(LtFloat t) { Set(eTRANSPARENCY, t, 0, 0); }
+
+private:
+   friend class MaterialPool;
+
+   enum Component
+   {
+      eDIFFUSE,
+      eAMBIENT,
+      eSPECULAR,
+      eEMISSIVE,
+      eSHININESS,
+      eTRANSPARENCY,
+      eNUM_COMPONENTS
+   };
+
+   void Set(Component c, LtFloat x, LtFloat y, LtFloat z);
+   bool Get(Component c, const LtFloat*& values) const
+   { values = m_values[c]; return (m_set & (1 << c)) != 0; }
+
+   LtFloat m_values[eNUM_COMPONENTS][3];
+   LtInt32 m_set;                      // Bit per component
+};
+
+// Hands out one shared LcNwcMaterial per distinct material state, so that
+// many nodes with the same colour reference a single attribute instead of
+// each carrying its own copy. Values are compared after rounding to the
+// given tolerance.
+class MaterialPool
+{
+public:
+   MaterialPool(LtFloat tolerance = 1e-6);
+
+   // Shared material for spec, created on first request.
+   LcNwcMaterial Get(const MaterialSpec& spec);
+
+   // Plain colour with matching ambient and diffuse, as the examples use
+   LcNwcMaterial GetColor(LtFloat r, LtFloat g, LtFloat b, LtFloat transparency = 0);
+
+   // Forgets all materials, e.g. between scenes
+   void Clear();
+
+   LtInt32 GetNumRequested() const { return m_num_requested; }
+   LtInt32 GetNumUnique() const { return LtInt32(m_materials.size()); }
+
+   // "Materials: N requested, M unique", for Gecko's scene statistics
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   MaterialPool(const MaterialPool&);
+   MaterialPool& operator= (const MaterialPool&);
+
+   enum { cKEY_SIZE = MaterialSpec::eNUM_COMPONENTS * 3 + 1 };
+
+   struct Key
+   {
+      LtInt64 values[cKEY_SIZE];
+
+      bool operator== (const Key& other) const;
+   };
+
+   struct KeyHash
+   {
+      size_t operator() (const Key& key) const;
+   };
+
+   LtFloat m_tolerance;
+   std::unordered_map<Key, LcNwcMaterial, KeyHash> m_materials;
+   LtInt32 m_num_requested;
+};
+
+#endif // MATERIALPOOL_HDR
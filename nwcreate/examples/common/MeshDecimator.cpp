@@ -0,0 +1,497 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "MeshDecimator.h"
+
+#include <math.h>
+#include <algorithm>
+#include <queue>
+
+//
+// Vector utilities
+//
+
+static inline void
+vec_sub(LtVector c, const LtPoint a, const LtPoint b)
+{
+   c[0] = a[0] - b[0];
+   c[1] = a[1] - b[1];
+   c[2] = a[2] - b[2];
+}
+
+static inline void
+vec_cross(LtVector c, const LtVector a, const LtVector b)
+{
+   c[0] = a[1] * b[2] - a[2] * b[1];
+   c[1] = a[2] * b[0] - a[0] * b[2];
+   c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static inline LtFloat
+vec_dot(const LtVector a, const LtVector b)
+{
+   return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline bool
+vec_normalize(LtVector a)
+{
+   LtFloat len = sqrt(vec_dot(a, a));
+   if (len <= 0)
+      return false;
+
+   a[0] /= len;
+   a[1] /= len;
+   a[2] /= len;
+   return true;
+}
+
+// Unnormalized normal of triangle
+static inline void
+triangle_normal(LtVector n, const LtPoint a, const LtPoint b, const LtPoint c)
+{
+   LtVector ab, ac;
+   vec_sub(ab, b, a);
+   vec_sub(ac, c, a);
+   vec_cross(n, ab, ac);
+}
+
+//
+// Quadric
+//
+
+void
+MeshDecimator::Quadric::Clear()
+{
+   for (int i = 0; i < 10; i++)
+      m[i] = 0;
+}
+
+void
+MeshDecimator::Quadric::AddPlane(LtFloat a, LtFloat b, LtFloat c, LtFloat d, LtFloat weight)
+{
+   m[0] += weight * a * a; m[1] += weight * a * b; m[2] += weight * a * c; m[3] += weight * a * d;
+   m[4] += weight * b * b; m[5] += weight * b * c; m[6] += weight * b * d;
+   m[7] += weight * c * c; m[8] += weight * c * d;
+   m[9] += weight * d * d;
+}
+
+void
+MeshDecimator::Quadric::Add(const Quadric& q)
+{
+   for (int i = 0; i < 10; i++)
+      m[i] += q.m[i];
+}
+
+// Sum of squared distances of p from the planes in the quadric
+LtFloat
+MeshDecimator::Quadric::Evaluate(const LtPoint p) const
+{
+   LtFloat x = p[0], y = p[1], z = p[2];
+   LtFloat e = m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x
+             + m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y
+             + m[7] * z * z + 2 * m[8] * z
+             + m[9];
+   return (e > 0) ? e : 0;
+}
+
+// Point with least error, if well defined
+bool
+MeshDecimator::Quadric::Minimize(LtPoint p) const
+{
+   LtFloat a00 = m[0], a01 = m[1], a02 = m[2];
+   LtFloat a11 = m[4], a12 = m[5], a22 = m[7];
+
+   LtFloat c00 = a11 * a22 - a12 * a12;
+   LtFloat c01 = a02 * a12 - a01 * a22;
+   LtFloat c02 = a01 * a12 - a02 * a11;
+   LtFloat det = a00 * c00 + a01 * c01 + a02 * c02;
+
+   LtFloat scale = a00 + a11 + a22;
+   if (scale <= 0 || fabs(det) < 1e-12 * scale * scale * scale)
+      return false;
+
+   LtFloat c11 = a00 * a22 - a02 * a02;
+   LtFloat c12 = a01 * a02 - a00 * a12;
+   LtFloat c22 = a00 * a11 - a01 * a01;
+
+   LtFloat bx = -m[3], by = -m[6], bz = -m[8];
+   p[0] = (c00 * bx + c01 * by + c02 * bz) / det;
+   p[1] = (c01 * bx + c11 * by + c12 * bz) / det;
+   p[2] = (c02 * bx + c12 * by + c22 * bz) / det;
+
+   return true;
+}
+
+//
+// MeshDecimator
+//
+
+MeshDecimator::MeshDecimator()
+   : m_num_vertices(0), m_num_triangles(0)
+{
+}
+
+void
+MeshDecimator::Clear()
+{
+   m_vertices.clear();
+   m_triangles.clear();
+   m_num_vertices = 0;
+   m_num_triangles = 0;
+}
+
+LtInt32
+MeshDecimator::AddVertex(LtFloat x, LtFloat y, LtFloat z)
+{
+   Vertex v;
+   v.pos[0] = x;
+   v.pos[1] = y;
+   v.pos[2] = z;
+   v.quadric.Clear();
+   v.version = 0;
+   v.removed = false;
+
+   m_vertices.push_back(v);
+   m_num_vertices++;
+
+   return LtInt32(m_vertices.size() - 1);
+}
+
+void
+MeshDecimator::AddTriangle(LtInt32 a, LtInt32 b, LtInt32 c)
+{
+   LtInt32 count = LtInt32(m_vertices.size());
+   if (a < 0 || b < 0 || c < 0 || a >= count || b >= count || c >= count ||
+       a == b || b == c || a == c)
+      return;
+
+   Triangle t;
+   t.v[0] = a;
+   t.v[1] = b;
+   t.v[2] = c;
+   t.removed = false;
+
+   LtInt32 index = LtInt32(m_triangles.size());
+   m_triangles.push_back(t);
+   m_num_triangles++;
+
+   m_vertices[a].triangles.push_back(index);
+   m_vertices[b].triangles.push_back(index);
+   m_vertices[c].triangles.push_back(index);
+}
+
+void
+MeshDecimator::Neighbours(LtInt32 v, std::vector<LtInt32>& neighbours) const
+{
+   neighbours.clear();
+
+   const std::vector<LtInt32>& tris = m_vertices[v].triangles;
+   for (size_t i = 0; i < tris.size(); i++)
+   {
+      const Triangle& t = m_triangles[tris[i]];
+      for (int k = 0; k < 3; k++)
+      {
+         if (t.v[k] != v)
+            neighbours.push_back(t.v[k]);
+      }
+   }
+
+   std::sort(neighbours.begin(), neighbours.end());
+   neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+}
+
+void
+MeshDecimator::ComputeQuadrics()
+{
+   for (size_t i = 0; i < m_vertices.size(); i++)
+      m_vertices[i].quadric.Clear();
+
+   // Unweighted planes, so error is a sum of squared distances
+   for (size_t i = 0; i < m_triangles.size(); i++)
+   {
+      const Triangle& t = m_triangles[i];
+      if (t.removed)
+         continue;
+
+      LtVector n;
+      triangle_normal(n, m_vertices[t.v[0]].pos, m_vertices[t.v[1]].pos, m_vertices[t.v[2]].pos);
+      if (!vec_normalize(n))
+         continue;
+
+      LtFloat d = -vec_dot(n, m_vertices[t.v[0]].pos);
+      for (int k = 0; k < 3; k++)
+         m_vertices[t.v[k]].quadric.AddPlane(n[0], n[1], n[2], d, 1);
+   }
+
+   AddBoundaryPlanes();
+}
+
+// Edges used by one triangle get a plane through the edge at right angles to
+// the triangle, so that boundary vertices only slide along the boundary.
+void
+MeshDecimator::AddBoundaryPlanes()
+{
+   for (size_t i = 0; i < m_triangles.size(); i++)
+   {
+      const Triangle& t = m_triangles[i];
+      if (t.removed)
+         continue;
+
+      for (int k = 0; k < 3; k++)
+      {
+         LtInt32 a = t.v[k], b = t.v[(k + 1) % 3];
+
+         LtInt32 shared = 0;
+         const std::vector<LtInt32>& tris = m_vertices[a].triangles;
+         for (size_t j = 0; j < tris.size(); j++)
+         {
+            const Triangle& o = m_triangles[tris[j]];
+            if (!o.removed && (o.v[0] == b || o.v[1] == b || o.v[2] == b))
+               shared++;
+         }
+         if (shared != 1)
+            continue;
+
+         LtVector n, edge, plane;
+         triangle_normal(n, m_vertices[t.v[0]].pos, m_vertices[t.v[1]].pos, m_vertices[t.v[2]].pos);
+         vec_sub(edge, m_vertices[b].pos, m_vertices[a].pos);
+         vec_cross(plane, edge, n);
+         if (!vec_normalize(plane))
+            continue;
+
+         LtFloat d = -vec_dot(plane, m_vertices[a].pos);
+         m_vertices[a].quadric.AddPlane(plane[0], plane[1], plane[2], d, 1);
+         m_vertices[b].quadric.AddPlane(plane[0], plane[1], plane[2], d, 1);
+      }
+   }
+}
+
+void
+MeshDecimator::PlanCollapse(LtInt32 keep, LtInt32 remove, Collapse& collapse) const
+{
+   const Vertex& vk = m_vertices[keep];
+   const Vertex& vr = m_vertices[remove];
+
+   Quadric q = vk.quadric;
+   q.Add(vr.quadric);
+
+   // Try optimal point, both ends and midpoint, keep the best
+   LtPoint candidates[4];
+   int num_candidates = 0;
+   if (q.Minimize(candidates[num_candidates]))
+      num_candidates++;
+   for (int k = 0; k < 3; k++)
+   {
+      candidates[num_candidates][k] = vk.pos[k];
+      candidates[num_candidates + 1][k] = vr.pos[k];
+      candidates[num_candidates + 2][k] = (vk.pos[k] + vr.pos[k]) * 0.5;
+   }
+   num_candidates += 3;
+
+   collapse.cost = -1;
+   for (int i = 0; i < num_candidates; i++)
+   {
+      LtFloat cost = q.Evaluate(candidates[i]);
+      if (collapse.cost < 0 || cost < collapse.cost)
+      {
+         collapse.cost = cost;
+         for (int k = 0; k < 3; k++)
+            collapse.target[k] = candidates[i][k];
+      }
+   }
+
+   collapse.keep = keep;
+   collapse.remove = remove;
+   collapse.keep_version = vk.version;
+   collapse.remove_version = vr.version;
+}
+
+bool
+MeshDecimator::CanCollapse(const Collapse& collapse) const
+{
+   const Vertex& vk = m_vertices[collapse.keep];
+   const Vertex& vr = m_vertices[collapse.remove];
+
+   if (vk.removed || vr.removed ||
+       vk.version != collapse.keep_version || vr.version != collapse.remove_version)
+      return false;
+
+   // Link condition: the only vertices next to both ends are the opposite
+   // corners of the triangles on the edge. Otherwise collapse pinches mesh.
+   std::vector<LtInt32> nk, nr;
+   Neighbours(collapse.keep, nk);
+   Neighbours(collapse.remove, nr);
+
+   if (!std::binary_search(nk.begin(), nk.end(), collapse.remove))
+      return false;
+
+   LtInt32 num_common = 0;
+   for (size_t i = 0; i < nk.size(); i++)
+   {
+      if (std::binary_search(nr.begin(), nr.end(), nk[i]))
+         num_common++;
+   }
+
+   LtInt32 num_edge_triangles = 0;
+   for (size_t i = 0; i < vr.triangles.size(); i++)
+   {
+      const Triangle& t = m_triangles[vr.triangles[i]];
+      if (t.v[0] == collapse.keep || t.v[1] == collapse.keep || t.v[2] == collapse.keep)
+         num_edge_triangles++;
+   }
+
+   if (num_common != num_edge_triangles)
+      return false;
+
+   // No triangle that survives may flip over
+   for (int end = 0; end < 2; end++)
+   {
+      LtInt32 moved = end ? collapse.remove : collapse.keep;
+      LtInt32 other = end ? collapse.keep : collapse.remove;
+      const std::vector<LtInt32>& tris = m_vertices[moved].triangles;
+
+      for (size_t i = 0; i < tris.size(); i++)
+      {
+         const Triangle& t = m_triangles[tris[i]];
+         if (t.v[0] == other || t.v[1] == other || t.v[2] == other)
+            continue;
+
+         const LtFloat* p[3];
+         const LtFloat* q[3];
+         for (int k = 0; k < 3; k++)
+         {
+            p[k] = m_vertices[t.v[k]].pos;
+            q[k] = (t.v[k] == moved) ? collapse.target : p[k];
+         }
+
+         LtVector before, after;
+         triangle_normal(before, p[0], p[1], p[2]);
+         triangle_normal(after, q[0], q[1], q[2]);
+         if (vec_dot(before, after) <= 0)
+            return false;
+      }
+   }
+
+   return true;
+}
+
+void
+MeshDecimator::DoCollapse(const Collapse& collapse)
+{
+   Vertex& vk = m_vertices[collapse.keep];
+   Vertex& vr = m_vertices[collapse.remove];
+
+   for (int k = 0; k < 3; k++)
+      vk.pos[k] = collapse.target[k];
+   vk.quadric.Add(vr.quadric);
+   vk.version++;
+
+   for (size_t i = 0; i < vr.triangles.size(); i++)
+   {
+      Triangle& t = m_triangles[vr.triangles[i]];
+      if (t.v[0] == collapse.keep || t.v[1] == collapse.keep || t.v[2] == collapse.keep)
+      {
+         t.removed = true;
+         m_num_triangles--;
+         continue;
+      }
+
+      for (int k = 0; k < 3; k++)
+      {
+         if (t.v[k] == collapse.remove)
+            t.v[k] = collapse.keep;
+      }
+      vk.triangles.push_back(vr.triangles[i]);
+   }
+
+   // Drop collapsed triangles from the other vertices that used them
+   for (size_t i = 0; i < vr.triangles.size(); i++)
+   {
+      const Triangle& t = m_triangles[vr.triangles[i]];
+      if (!t.removed)
+         continue;
+
+      for (int k = 0; k < 3; k++)
+      {
+         if (t.v[k] == collapse.remove)
+            continue;
+
+         std::vector<LtInt32>& tris = m_vertices[t.v[k]].triangles;
+         tris.erase(std::remove(tris.begin(), tris.end(), vr.triangles[i]), tris.end());
+      }
+   }
+
+   vr.triangles.clear();
+   vr.removed = true;
+   m_num_vertices--;
+}
+
+void
+MeshDecimator::Simplify(LtFloat max_error)
+{
+   if (max_error <= 0)
+      return;
+
+   ComputeQuadrics();
+
+   LtFloat max_cost = max_error * max_error;
+   std::priority_queue<Collapse> heap;
+   std::vector<LtInt32> neighbours;
+
+   for (LtInt32 v = 0; v < LtInt32(m_vertices.size()); v++)
+   {
+      if (m_vertices[v].removed)
+         continue;
+
+      Neighbours(v, neighbours);
+      for (size_t i = 0; i < neighbours.size(); i++)
+      {
+         if (neighbours[i] < v)
+            continue;
+
+         Collapse collapse;
+         PlanCollapse(v, neighbours[i], collapse);
+         if (collapse.cost <= max_cost)
+            heap.push(collapse);
+      }
+   }
+
+   while (!heap.empty())
+   {
+      Collapse collapse = heap.top();
+      heap.pop();
+
+      if (!CanCollapse(collapse))
+         continue;
+
+      DoCollapse(collapse);
+
+      // Edges around moved vertex have new costs
+      Neighbours(collapse.keep, neighbours);
+      for (size_t i = 0; i < neighbours.size(); i++)
+      {
+         Collapse next;
+         PlanCollapse(collapse.keep, neighbours[i], next);
+         if (next.cost <= max_cost)
+            heap.push(next);
+      }
+   }
+}
@@ -0,0 +1,134 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef MESHDECIMATOR_HDR
+#define MESHDECIMATOR_HDR
+#pragma once
+
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Simplifies an indexed triangle mesh by quadric error edge collapse
+// (Garland and Heckbert) before it is written to a geometry stream.
+//
+// The error bound is a distance in model units, playing the same role for
+// meshes as MaxFacetDeviation does for analytic primitives. An edge is only
+// collapsed if the moved vertex stays within that distance of the planes of
+// the triangles it replaces. Open boundaries are held in place by extra
+// planes, and collapses that would fold a triangle over or make the mesh
+// non-manifold are skipped.
+class MeshDecimator
+{
+public:
+   MeshDecimator();
+
+   void Clear();
+
+   // Mesh definition, indices start at 0 in the order vertices are added.
+   LtInt32 AddVertex(LtFloat x, LtFloat y, LtFloat z);
+   void AddTriangle(LtInt32 a, LtInt32 b, LtInt32 c);
+
+   // Collapses edges while the error stays within max_error.
+   void Simplify(LtFloat max_error);
+
+   LtInt32 GetNumVertices() const { return m_num_vertices; }
+   LtInt32 GetNumTriangles() const { return m_num_triangles; }
+
+   // Writes surviving triangles as IndexedVertex and TriangleIndex calls.
+   // Must be called between Begin and End on an LcNwcGeometryStream or a
+   // GeometryRecorder.
+   template <class Stream> void Emit(Stream& stream) const;
+
+private:
+   struct Quadric
+   {
+      LtFloat m[10];    // Upper triangle of symmetric 4x4 matrix
+
+      void Clear();
+      void AddPlane(LtFloat a, LtFloat b, LtFloat c, LtFloat d, LtFloat weight);
+      void Add(const Quadric& q);
+      LtFloat Evaluate(const LtPoint p) const;
+      bool Minimize(LtPoint p) const;
+   };
+
+   struct Vertex
+   {
+      LtPoint pos;
+      Quadric quadric;
+      LtInt32 version;              // Bumped when vertex moves
+      bool removed;
+      std::vector<LtInt32> triangles;
+   };
+
+   struct Triangle
+   {
+      LtInt32 v[3];
+      bool removed;
+   };
+
+   struct Collapse
+   {
+      LtFloat cost;
+      LtInt32 keep, remove;
+      LtInt32 keep_version, remove_version;
+      LtPoint target;
+
+      bool operator< (const Collapse& other) const { return cost > other.cost; }
+   };
+
+   void ComputeQuadrics();
+   void AddBoundaryPlanes();
+   void PlanCollapse(LtInt32 keep, LtInt32 remove, Collapse& collapse) const;
+   bool CanCollapse(const Collapse& collapse) const;
+   void DoCollapse(const Collapse& collapse);
+   void Neighbours(LtInt32 v, std::vector<LtInt32>& neighbours) const;
+
+   std::vector<Vertex> m_vertices;
+   std::vector<Triangle> m_triangles;
+   LtInt32 m_num_vertices;
+   LtInt32 m_num_triangles;
+};
+
+template <class Stream> void
+MeshDecimator::Emit(Stream& stream) const
+{
+   std::vector<LtInt32> index(m_vertices.size(), -1);
+
+   for (size_t i = 0; i < m_triangles.size(); i++)
+   {
+      const Triangle& t = m_triangles[i];
+      if (t.removed)
+         continue;
+
+      for (int k = 0; k < 3; k++)
+      {
+         LtInt32 v = t.v[k];
+         if (index[v] < 0)
+            index[v] = stream.IndexedVertex(m_vertices[v].pos);
+      }
+
+      stream.TriangleIndex(index[t.v[0]]);
+      stream.TriangleIndex(index[t.v[1]]);
+      stream.TriangleIndex(index[t.v[2]]);
+   }
+}
+
+#endif // MESHDECIMATOR_HDR
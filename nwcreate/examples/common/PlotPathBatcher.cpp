@@ -0,0 +1,136 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "PlotPathBatcher.h"
+
+#include <wchar.h>
+
+PlotPathBatcher::PlotPathBatcher(LtInt32 max_figures)
+   : m_max_figures(max_figures),
+     m_plot_stream(NULL),
+     m_path_stream(NULL),
+     m_open_style(-1),
+     m_open_figures(0),
+     m_num_paths(0),
+     m_num_figures(0)
+{
+}
+
+LtInt32
+PlotPathBatcher::AddStyle(const LtFloat* fill, const LtFloat* stroke, LtFloat thickness,
+                          LtNwcPlotPathFillRule fill_rule)
+{
+   StyleKey key;
+   for (int i = 0; i < 4; i++)
+   {
+      key.values[i] = fill ? fill[i] : -1;
+      key.values[4 + i] = stroke ? stroke[i] : -1;
+   }
+   key.values[8] = thickness;
+   key.values[9] = LtFloat(fill_rule);
+
+   std::map<StyleKey, LtInt32>::const_iterator found = m_style_index.find(key);
+   if (found != m_style_index.end())
+      return found->second;
+
+   Style style;
+   if (fill)
+   {
+      style.fill.SetColor(fill[0], fill[1], fill[2], fill[3]);
+      style.path_style.SetFill(style.fill);
+   }
+   if (stroke)
+   {
+      // Same colour shares the fill brush
+      if (fill && std::equal(fill, fill + 4, stroke))
+         style.stroke_brush = style.fill;
+      else
+         style.stroke_brush.SetColor(stroke[0], stroke[1], stroke[2], stroke[3]);
+      style.stroke.SetBrush(style.stroke_brush);
+      if (thickness > 0)
+         style.stroke.SetThickness(thickness);
+      style.path_style.SetStroke(style.stroke);
+   }
+   style.stream_style.SetFillRule(fill_rule);
+
+   LtInt32 index = LtInt32(m_styles.size());
+   m_styles.push_back(style);
+   m_style_index[key] = index;
+   return index;
+}
+
+LcNwcPlotGeometryStream
+PlotPathBatcher::FigureBegin(LcNwcPlotStream stream, LtInt32 style)
+{
+   if (m_path_stream &&
+       (m_plot_stream != stream.GetHandle() || m_open_style != style ||
+        (m_max_figures > 0 && m_open_figures >= m_max_figures)))
+   {
+      Flush();
+   }
+
+   if (!m_path_stream)
+   {
+      // Only one path geometry stream is allowed in a path
+      stream.PathBegin(m_styles[style].path_style);
+      m_plot_stream = stream.GetHandle();
+      m_path_stream = stream.PathStreamOpen(m_styles[style].stream_style);
+      m_open_style = style;
+      m_num_paths++;
+   }
+
+   LcNwcPlotGeometryStream path_stream(m_path_stream);
+   path_stream.PathFigureBegin(m_figure_style);
+   m_open_figures++;
+   m_num_figures++;
+   return path_stream;
+}
+
+void
+PlotPathBatcher::FigureEnd()
+{
+   LcNwcPlotGeometryStream(m_path_stream).PathFigureEnd();
+}
+
+void
+PlotPathBatcher::Flush()
+{
+   if (!m_path_stream)
+      return;
+
+   LcNwcPlotStream stream(m_plot_stream);
+   stream.PathStreamClose(m_path_stream);
+   stream.PathEnd();
+
+   m_plot_stream = NULL;
+   m_path_stream = NULL;
+   m_open_style = -1;
+   m_open_figures = 0;
+}
+
+std::wstring
+PlotPathBatcher::GetStatistics() const
+{
+   wchar_t line[128];
+   swprintf_s(line, L"Plot paths: %d figures in %d paths, %d styles",
+              m_num_figures, m_num_paths, GetNumStyles());
+   return line;
+}
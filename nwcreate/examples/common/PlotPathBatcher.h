@@ -0,0 +1,109 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef PLOTPATHBATCHER_HDR
+#define PLOTPATHBATCHER_HDR
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Shares plot path styles between figures and draws runs of figures with
+// the same style as one path.
+//
+// Each distinct combination of fill colour, stroke colour, thickness and
+// fill rule is made into brushes, a stroke and a path style once, the first
+// time AddStyle is called for it. FigureBegin then continues the path that
+// is open on the plot stream if it has the same style, so a drawing of many
+// small symbols in a few styles needs a few paths rather than one per
+// symbol. A merged path is culled and selected as one, so at most
+// max_figures go into each.
+class PlotPathBatcher
+{
+public:
+   // Zero max_figures for no limit
+   PlotPathBatcher(LtInt32 max_figures = 1024);
+
+   // Index of the style, made if new. Colours are r, g, b, a; a NULL colour
+   // leaves out the fill or stroke. Zero thickness keeps the stroke default.
+   LtInt32 AddStyle(const LtFloat* fill, const LtFloat* stroke, LtFloat thickness = 0,
+                    LtNwcPlotPathFillRule fill_rule = LI_NWC_PLOT_PATH_FILL_RULE_NONE);
+
+   // Starts a figure in style, continuing the open path where possible, and
+   // returns the stream to add its segments to.
+   LcNwcPlotGeometryStream FigureBegin(LcNwcPlotStream stream, LtInt32 style);
+   void FigureEnd();
+
+   // Ends the open path. Call before closing the plot stream.
+   void Flush();
+
+   LtInt32 GetNumStyles() const { return LtInt32(m_styles.size()); }
+   LtInt32 GetNumPaths() const { return m_num_paths; }
+   LtInt32 GetNumFigures() const { return m_num_figures; }
+
+   // "Plot paths: N figures in M paths, S styles"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   PlotPathBatcher(const PlotPathBatcher&);
+   PlotPathBatcher& operator= (const PlotPathBatcher&);
+
+   // Fill, stroke, thickness and fill rule. Alpha of -1 for no fill or stroke.
+   struct StyleKey
+   {
+      LtFloat values[10];
+
+      bool operator< (const StyleKey& other) const
+      {
+         return std::lexicographical_compare(values, values + 10, other.values, other.values + 10);
+      }
+   };
+
+   struct Style
+   {
+      LcNwcPlotSolidColorBrush fill;
+      LcNwcPlotSolidColorBrush stroke_brush;
+      LcNwcPlotStroke stroke;
+      LcNwcPlotPathStyle path_style;
+      LcNwcPlotPathStreamStyle stream_style;
+   };
+
+   LtInt32 m_max_figures;
+   std::map<StyleKey, LtInt32> m_style_index;
+   std::vector<Style> m_styles;
+   LcNwcPlotPathFigureStyle m_figure_style;
+
+   // Path open on m_plot_stream, if any
+   LtNwcPlotStream m_plot_stream;
+   LtNwcPlotGeometryStream m_path_stream;
+   LtInt32 m_open_style;
+   LtInt32 m_open_figures;
+
+   LtInt32 m_num_paths;
+   LtInt32 m_num_figures;
+};
+
+#endif // PLOTPATHBATCHER_HDR
@@ -0,0 +1,193 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "PlotTiler.h"
+
+#include <wchar.h>
+#include <algorithm>
+
+// Deeper cells are left as they are, however many items share them
+static const LtInt32 cMAX_DEPTH = 16;
+
+PlotTiler::PlotTiler(LtInt32 max_items)
+   : m_max_items(max_items),
+     m_clip_margin(0)
+{
+}
+
+LtInt32
+PlotTiler::AddItem(const LtPoint2d min, const LtPoint2d max)
+{
+   LtInt32 item = GetNumItems();
+   m_centers.push_back((min[0] + max[0]) / 2);
+   m_centers.push_back((min[1] + max[1]) / 2);
+   m_bounds.push_back(min[0]);
+   m_bounds.push_back(min[1]);
+   m_bounds.push_back(max[0]);
+   m_bounds.push_back(max[1]);
+   return item;
+}
+
+void
+PlotTiler::Build()
+{
+   LtInt32 num_items = GetNumItems();
+   m_tiles.clear();
+   m_order.resize(num_items);
+   for (LtInt32 i = 0; i < num_items; i++)
+      m_order[i] = i;
+   if (num_items == 0)
+      return;
+
+   // Square cell around every center
+   LtFloat cell[4] = { m_centers[0], m_centers[1], m_centers[0], m_centers[1] };
+   for (LtInt32 i = 1; i < num_items; i++)
+   {
+      cell[0] = std::min(cell[0], m_centers[i * 2]);
+      cell[1] = std::min(cell[1], m_centers[i * 2 + 1]);
+      cell[2] = std::max(cell[2], m_centers[i * 2]);
+      cell[3] = std::max(cell[3], m_centers[i * 2 + 1]);
+   }
+   LtFloat size = std::max(cell[2] - cell[0], cell[3] - cell[1]);
+   cell[2] = cell[0] + size;
+   cell[3] = cell[1] + size;
+
+   Split(0, num_items, cell, 0);
+}
+
+void
+PlotTiler::Split(LtInt32 first, LtInt32 end, const LtFloat cell[4], LtInt32 depth)
+{
+   LtInt32 num_items = end - first;
+   bool leaf = m_max_items <= 0 || num_items <= m_max_items || depth >= cMAX_DEPTH ||
+               cell[2] <= cell[0];
+
+   if (!leaf)
+   {
+      LtFloat mid[2] = { (cell[0] + cell[2]) / 2, (cell[1] + cell[3]) / 2 };
+
+      // Partition into quadrants in Z order: by y, then each half by x
+      const std::vector<LtFloat>& centers = m_centers;
+      std::vector<LtInt32>::iterator begin = m_order.begin() + first;
+      std::vector<LtInt32>::iterator y_split = std::stable_partition(begin, m_order.begin() + end,
+         [&centers, &mid](LtInt32 i) { return centers[i * 2 + 1] < mid[1]; });
+      std::vector<LtInt32>::iterator x_split[2] = {
+         std::stable_partition(begin, y_split,
+            [&centers, &mid](LtInt32 i) { return centers[i * 2] < mid[0]; }),
+         std::stable_partition(y_split, m_order.begin() + end,
+            [&centers, &mid](LtInt32 i) { return centers[i * 2] < mid[0]; }) };
+
+      LtInt32 bounds[5] = { first, LtInt32(x_split[0] - m_order.begin()),
+                            LtInt32(y_split - m_order.begin()),
+                            LtInt32(x_split[1] - m_order.begin()), end };
+      for (int q = 0; q < 4; q++)
+      {
+         if (bounds[q] == bounds[q + 1])
+            continue;
+
+         LtFloat child[4] = { (q & 1) ? mid[0] : cell[0], (q & 2) ? mid[1] : cell[1],
+                              (q & 1) ? cell[2] : mid[0], (q & 2) ? cell[3] : mid[1] };
+         Split(bounds[q], bounds[q + 1], child, depth + 1);
+      }
+      return;
+   }
+
+   Tile tile;
+   tile.first = first;
+   tile.num_items = num_items;
+
+   const LtFloat* b = &m_bounds[m_order[first] * 4];
+   std::copy(b, b + 4, tile.bounds);
+   for (LtInt32 i = first + 1; i < end; i++)
+   {
+      b = &m_bounds[m_order[i] * 4];
+      tile.bounds[0] = std::min(tile.bounds[0], b[0]);
+      tile.bounds[1] = std::min(tile.bounds[1], b[1]);
+      tile.bounds[2] = std::max(tile.bounds[2], b[2]);
+      tile.bounds[3] = std::max(tile.bounds[3], b[3]);
+   }
+   m_tiles.push_back(tile);
+}
+
+const LtInt32*
+PlotTiler::GetTileItems(LtInt32 tile) const
+{
+   return &m_order[m_tiles[tile].first];
+}
+
+void
+PlotTiler::GetTileBounds(LtInt32 tile, LtPoint2d min, LtPoint2d max) const
+{
+   const LtFloat* b = m_tiles[tile].bounds;
+   min[0] = b[0];
+   min[1] = b[1];
+   max[0] = b[2];
+   max[1] = b[3];
+}
+
+void
+PlotTiler::CanvasBegin(LcNwcPlotStream stream, LtInt32 tile) const
+{
+   const LtFloat* t = m_tiles[tile].bounds;
+   LtFloat m = m_clip_margin;
+   LtFloat b[4] = { t[0] - m, t[1] - m, t[2] + m, t[3] + m };
+   LtPoint2d corners[5] = {
+      { b[0], b[1] }, { b[2], b[1] }, { b[2], b[3] }, { b[0], b[3] }, { b[0], b[1] } };
+
+   // Clip to the tile's bounds, which hold all of its content, padded so
+   // strokes on the edge are drawn whole
+   LcNwcPlotCanvasStyle canvas_style;
+   LcNwcPlotPathStreamStyle clip_style;
+   clip_style.SetFillRule(LI_NWC_PLOT_PATH_FILL_RULE_NON_ZERO);
+   LcNwcPlotGeometryStream clip = canvas_style.ClipStreamOpen(clip_style);
+
+   LcNwcPlotPathFigureStyle figure_style;
+   figure_style.SetIsClosed(true);
+   figure_style.SetIsFilled(true);
+   clip.PathFigureBegin(figure_style);
+   clip.PolyLineSegmentBegin(false);
+   for (int i = 0; i < 5; i++)
+      clip.PolyLineSegmentPoint(corners[i]);
+   clip.PolyLineSegmentEnd();
+   clip.PathFigureEnd();
+   canvas_style.ClipStreamClose(clip);
+
+   stream.CanvasBegin(canvas_style);
+}
+
+void
+PlotTiler::CanvasEnd(LcNwcPlotStream stream) const
+{
+   stream.CanvasEnd();
+}
+
+std::wstring
+PlotTiler::GetStatistics() const
+{
+   LtInt32 largest = 0;
+   for (size_t i = 0; i < m_tiles.size(); i++)
+      largest = std::max(largest, m_tiles[i].num_items);
+
+   wchar_t buffer[256];
+   swprintf(buffer, 256, L"Plot tiles: %d items in %d tiles, largest %d",
+            GetNumItems(), GetNumTiles(), largest);
+   return buffer;
+}
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef PLOTTILER_HDR
+#define PLOTTILER_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Bins the items of a large 2D sheet into tiles with a quadtree, so each
+// tile can be drawn into its own geometry node and culled on its own.
+//
+// Items are added with their bounds and binned by the center of those
+// bounds: a quadtree cell is split into four until it holds no more than
+// max_items. Each tile is a leaf cell, with bounds tight around its items
+// rather than the cell, so tiles may overlap a little where items cross
+// cell edges. Tiles are in Z order, so neighbouring tiles stay together.
+//
+// Tiles don't share state, so their contents can be prepared on worker
+// threads, as long as NWcreate calls stay on one thread.
+class PlotTiler
+{
+public:
+   // Zero max_items for a single tile
+   PlotTiler(LtInt32 max_items = 4096);
+
+   // Returns the item index, in order from zero
+   LtInt32 AddItem(const LtPoint2d min, const LtPoint2d max);
+
+   // Bins items into tiles. Call after adding every item.
+   void Build();
+
+   LtInt32 GetNumTiles() const { return LtInt32(m_tiles.size()); }
+   LtInt32 GetNumItems() const { return LtInt32(m_centers.size() / 2); }
+
+   // Items of tile, in the order they were added
+   const LtInt32* GetTileItems(LtInt32 tile) const;
+   LtInt32 GetNumTileItems(LtInt32 tile) const { return m_tiles[tile].num_items; }
+   void GetTileBounds(LtInt32 tile, LtPoint2d min, LtPoint2d max) const;
+
+   // Wraps the tile's content in a canvas clipped to its bounds grown by
+   // margin. Item bounds are geometric, so margin should be at least half
+   // the thickest stroke or the outer half of strokes on the edge is lost.
+   // Only the tile's own items are in the canvas, so a wide margin costs
+   // nothing.
+   void SetClipMargin(LtFloat margin) { m_clip_margin = margin; }
+   void CanvasBegin(LcNwcPlotStream stream, LtInt32 tile) const;
+   void CanvasEnd(LcNwcPlotStream stream) const;
+
+   // "Plot tiles: N items in M tiles, largest L"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   PlotTiler(const PlotTiler&);
+   PlotTiler& operator= (const PlotTiler&);
+
+   struct Tile
+   {
+      LtInt32 first;          // into m_order
+      LtInt32 num_items;
+      LtFloat bounds[4];      // min x, min y, max x, max y
+   };
+
+   void Split(LtInt32 first, LtInt32 end, const LtFloat cell[4], LtInt32 depth);
+
+   LtInt32 m_max_items;
+   LtFloat m_clip_margin;
+
+   // Per item, x, y and min x, min y, max x, max y
+   std::vector<LtFloat> m_centers;
+   std::vector<LtFloat> m_bounds;
+
+   // Items grouped by tile
+   std::vector<LtInt32> m_order;
+   std::vector<Tile> m_tiles;
+};
+
+#endif // PLOTTILER_HDR
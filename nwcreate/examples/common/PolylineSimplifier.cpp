@@ -0,0 +1,295 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "PolylineSimplifier.h"
+
+#include <math.h>
+#include <wchar.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+PolylineSimplifier::PolylineSimplifier(LtFloat tolerance, Method method)
+   : m_tolerance(tolerance),
+     m_method(method),
+     m_num_points_in(0),
+     m_num_points_out(0)
+{
+}
+
+void
+PolylineSimplifier::Simplify(const LtPoint2d* points, LtInt32 num_points, std::vector<LtInt32>& keep)
+{
+   keep.clear();
+   if (m_tolerance <= 0 || num_points < 3)
+   {
+      for (LtInt32 i = 0; i < num_points; i++)
+         keep.push_back(i);
+      return;
+   }
+
+   // Structure of arrays, so the distance loops vectorize
+   m_x.resize(num_points);
+   m_y.resize(num_points);
+   for (LtInt32 i = 0; i < num_points; i++)
+   {
+      m_x[i] = points[i][0];
+      m_y[i] = points[i][1];
+   }
+
+   bool closed = num_points >= 4 &&
+                 m_x[0] == m_x[num_points - 1] && m_y[0] == m_y[num_points - 1];
+
+   // A closed outline of up to four sides has no point to spare: dropping
+   // a corner changes the figure rather than thinning it
+   if (closed && num_points <= 5)
+   {
+      for (LtInt32 i = 0; i < num_points; i++)
+         keep.push_back(i);
+      return;
+   }
+
+   m_kept.assign(num_points, 0);
+   if (m_method == eVISVALINGAM)
+      Visvalingam(num_points, closed);
+   else
+      DouglasPeucker(num_points, closed);
+
+   for (LtInt32 i = 0; i < num_points; i++)
+   {
+      if (m_kept[i])
+         keep.push_back(i);
+   }
+}
+
+// Point between first and last furthest from the line through them, or
+// from first if they're the same point. distance2 is its squared distance.
+LtInt32
+PolylineSimplifier::Farthest(LtInt32 first, LtInt32 last, LtFloat& distance2)
+{
+   const LtFloat* x = m_x.data();
+   const LtFloat* y = m_y.data();
+   LtFloat* d = m_distance.data();
+
+   LtFloat x0 = x[first], y0 = y[first];
+   LtFloat dx = x[last] - x0, dy = y[last] - y0;
+   LtFloat length2 = dx * dx + dy * dy;
+
+   // Squared cross product is squared distance times length2, which saves
+   // a division per point
+   if (length2 > 0)
+   {
+      for (LtInt32 i = first + 1; i < last; i++)
+      {
+         LtFloat c = dx * (y[i] - y0) - dy * (x[i] - x0);
+         d[i] = c * c;
+      }
+   }
+   else
+   {
+      for (LtInt32 i = first + 1; i < last; i++)
+         d[i] = (x[i] - x0) * (x[i] - x0) + (y[i] - y0) * (y[i] - y0);
+   }
+
+   LtInt32 farthest = first + 1;
+   for (LtInt32 i = first + 2; i < last; i++)
+   {
+      if (d[i] > d[farthest])
+         farthest = i;
+   }
+
+   distance2 = (length2 > 0) ? d[farthest] / length2 : d[farthest];
+   return farthest;
+}
+
+void
+PolylineSimplifier::DouglasPeucker(LtInt32 num_points, bool closed)
+{
+   m_distance.resize(num_points);
+   LtFloat tolerance2 = m_tolerance * m_tolerance;
+   LtInt32 last = num_points - 1;
+
+   m_kept[0] = m_kept[last] = 1;
+
+   if (closed)
+   {
+      // Ends are the same point, so split at the point furthest from it
+      // and keep a third corner on the wider side
+      LtFloat distance2;
+      LtInt32 split = Farthest(0, last, distance2);
+      if (distance2 == 0)
+         return;
+      m_kept[split] = 1;
+
+      LtFloat before = 0, after = 0;
+      LtInt32 corner_before = (split > 1) ? Farthest(0, split, before) : 0;
+      LtInt32 corner_after = (last - split > 1) ? Farthest(split, last, after) : 0;
+      if (before > 0 && before >= after)
+         m_kept[corner_before] = 1;
+      else if (after > 0)
+         m_kept[corner_after] = 1;
+   }
+
+   // Ranges between the points kept so far
+   std::vector<std::pair<LtInt32, LtInt32> > ranges;
+   for (LtInt32 first = 0, i = 1; i < num_points; i++)
+   {
+      if (m_kept[i])
+      {
+         ranges.push_back(std::make_pair(first, i));
+         first = i;
+      }
+   }
+
+   while (!ranges.empty())
+   {
+      LtInt32 first = ranges.back().first;
+      LtInt32 end = ranges.back().second;
+      ranges.pop_back();
+      if (end - first < 2)
+         continue;
+
+      LtFloat distance2;
+      LtInt32 farthest = Farthest(first, end, distance2);
+      if (distance2 <= tolerance2)
+         continue;
+
+      m_kept[farthest] = 1;
+      ranges.push_back(std::make_pair(first, farthest));
+      ranges.push_back(std::make_pair(farthest, end));
+   }
+}
+
+// Twice the area of the triangle abc
+static LtFloat
+triangle_area2(const LtFloat* x, const LtFloat* y, LtInt32 a, LtInt32 b, LtInt32 c)
+{
+   return fabs((x[b] - x[a]) * (y[c] - y[a]) - (y[b] - y[a]) * (x[c] - x[a]));
+}
+
+void
+PolylineSimplifier::Visvalingam(LtInt32 num_points, bool closed)
+{
+   const LtFloat* x = m_x.data();
+   const LtFloat* y = m_y.data();
+   LtInt32 last = num_points - 1;
+
+   std::vector<LtInt32> prev(num_points), next(num_points);
+   m_distance.resize(num_points);
+   LtFloat* area = m_distance.data();
+
+   typedef std::pair<LtFloat, LtInt32> Entry;
+   std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > heap;
+
+   for (LtInt32 i = 0; i < num_points; i++)
+   {
+      prev[i] = i - 1;
+      next[i] = i + 1;
+      m_kept[i] = 1;
+      if (i > 0 && i < last)
+      {
+         area[i] = triangle_area2(x, y, i - 1, i, i + 1) * 0.5;
+         heap.push(Entry(area[i], i));
+      }
+   }
+
+   // Keep a closed polyline a triangle at least
+   LtFloat min_area = m_tolerance * m_tolerance;
+   LtInt32 num_left = num_points;
+   LtInt32 min_left = closed ? 4 : 2;
+
+   LtFloat last_area = 0;
+   while (!heap.empty() && num_left > min_left)
+   {
+      Entry entry = heap.top();
+      heap.pop();
+
+      LtInt32 i = entry.second;
+      if (!m_kept[i] || entry.first != area[i])
+         continue;
+      if (entry.first >= min_area)
+         break;
+
+      m_kept[i] = 0;
+      num_left--;
+      last_area = entry.first;
+
+      LtInt32 p = prev[i], n = next[i];
+      next[p] = n;
+      prev[n] = p;
+
+      // Neighbours can't drop out before a point already dropped, so the
+      // smallest features go first
+      if (p > 0)
+      {
+         area[p] = std::max(triangle_area2(x, y, prev[p], p, n) * 0.5, last_area);
+         heap.push(Entry(area[p], p));
+      }
+      if (n < last)
+      {
+         area[n] = std::max(triangle_area2(x, y, p, n, next[n]) * 0.5, last_area);
+         heap.push(Entry(area[n], n));
+      }
+   }
+}
+
+void
+PolylineSimplifier::PolyLineSegment(LcNwcPlotGeometryStream stream, bool is_stroked,
+                                    const LtPoint2d* points, LtInt32 num_points)
+{
+   Simplify(points, num_points, m_keep);
+
+   stream.PolyLineSegmentBegin(is_stroked);
+   for (size_t i = 0; i < m_keep.size(); i++)
+   {
+      LtPoint2d point = { points[m_keep[i]][0], points[m_keep[i]][1] };
+      stream.PolyLineSegmentPoint(point);
+   }
+   stream.PolyLineSegmentEnd();
+
+   m_num_points_in += num_points;
+   m_num_points_out += LtInt32(m_keep.size());
+}
+
+void
+PolylineSimplifier::PointListSegment(LcNwcPlotGeometryStream stream, bool is_stroked,
+                                     const LtPoint2d* points, LtInt32 num_points)
+{
+   stream.PointListSegmentBegin(is_stroked);
+   for (LtInt32 i = 0; i < num_points; i++)
+   {
+      LtPoint2d point = { points[i][0], points[i][1] };
+      stream.PointListSegmentPoint(point);
+   }
+   stream.PointListSegmentEnd();
+
+   m_num_points_in += num_points;
+   m_num_points_out += num_points;
+}
+
+std::wstring
+PolylineSimplifier::GetStatistics() const
+{
+   wchar_t buffer[128];
+   swprintf(buffer, 128, L"Plot polylines: %d points in, %d out",
+            m_num_points_in, m_num_points_out);
+   return buffer;
+}
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef POLYLINESIMPLIFIER_HDR
+#define POLYLINESIMPLIFIER_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Drops points from plot polylines that are within a tolerance of the line
+// through the points either side, before they are streamed. GIS and
+// contour overlays often have millions of nearly collinear points that
+// can't be seen on the sheet.
+//
+// The tolerance is a distance in the units of the points, the paper units
+// of the sheet. Douglas-Peucker keeps every point further than tolerance
+// from the simplified line. Visvalingam-Whyatt repeatedly drops the point
+// whose triangle with its neighbours is smallest, until every triangle
+// has an area of at least tolerance squared; it keeps the overall shape of
+// noisy lines better.
+//
+// The first and last points are always kept. A closed polyline, whose last
+// point is the same as its first, stays closed and keeps at least three
+// corners; one of four sides or fewer is kept whole. Point lists are
+// streamed as they are, as each point is a mark of its own.
+class PolylineSimplifier
+{
+public:
+   enum Method
+   {
+      eDOUGLAS_PEUCKER,
+      eVISVALINGAM
+   };
+
+   // Zero tolerance streams every point
+   PolylineSimplifier(LtFloat tolerance = 0, Method method = eDOUGLAS_PEUCKER);
+
+   void SetTolerance(LtFloat tolerance) { m_tolerance = tolerance; }
+   LtFloat GetTolerance() const { return m_tolerance; }
+   void SetMethod(Method method) { m_method = method; }
+
+   // Indices of the points to keep, in order
+   void Simplify(const LtPoint2d* points, LtInt32 num_points, std::vector<LtInt32>& keep);
+
+   // Streams points as one polyline segment, simplified
+   void PolyLineSegment(LcNwcPlotGeometryStream stream, bool is_stroked,
+                        const LtPoint2d* points, LtInt32 num_points);
+
+   // Streams points as one point list segment, unchanged
+   void PointListSegment(LcNwcPlotGeometryStream stream, bool is_stroked,
+                         const LtPoint2d* points, LtInt32 num_points);
+
+   LtInt32 GetNumPointsIn() const { return m_num_points_in; }
+   LtInt32 GetNumPointsOut() const { return m_num_points_out; }
+   void ClearStatistics() { m_num_points_in = m_num_points_out = 0; }
+
+   // "Plot polylines: N points in, M out"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   PolylineSimplifier(const PolylineSimplifier&);
+   PolylineSimplifier& operator= (const PolylineSimplifier&);
+
+   void DouglasPeucker(LtInt32 num_points, bool closed);
+   void Visvalingam(LtInt32 num_points, bool closed);
+   LtInt32 Farthest(LtInt32 first, LtInt32 last, LtFloat& distance2);
+
+   LtFloat m_tolerance;
+   Method m_method;
+
+   // Scratch, kept between calls
+   std::vector<LtFloat> m_x;
+   std::vector<LtFloat> m_y;
+   std::vector<LtFloat> m_distance;
+   std::vector<char> m_kept;
+   std::vector<LtInt32> m_keep;
+
+   LtInt32 m_num_points_in;
+   LtInt32 m_num_points_out;
+};
+
+#endif // POLYLINESIMPLIFIER_HDR
@@ -0,0 +1,130 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "ProcessPool.h"
+
+#include <chrono>
+#include <windows.h>
+
+ProcessPool::ProcessPool(LtInt32 max_processes)
+   : m_max_processes(max_processes)
+{
+   if (m_max_processes <= 0)
+   {
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      m_max_processes = LtInt32(info.dwNumberOfProcessors);
+   }
+
+   // Limit of WaitForMultipleObjects
+   if (m_max_processes > MAXIMUM_WAIT_OBJECTS)
+      m_max_processes = MAXIMUM_WAIT_OBJECTS;
+}
+
+LtInt32
+ProcessPool::Add(const std::wstring& arguments)
+{
+   Job job;
+   job.arguments = arguments;
+   job.exit_code = -1;
+   job.seconds = 0;
+   m_jobs.push_back(job);
+
+   return LtInt32(m_jobs.size() - 1);
+}
+
+bool
+ProcessPool::Run()
+{
+   wchar_t exe[MAX_PATH];
+   if (!GetModuleFileNameW(NULL, exe, MAX_PATH))
+      return false;
+
+   typedef std::chrono::steady_clock Clock;
+
+   std::vector<HANDLE> running;
+   std::vector<size_t> running_jobs;
+   std::vector<Clock::time_point> started;
+   size_t next = 0;
+   bool ok = true;
+
+   while (next < m_jobs.size() || !running.empty())
+   {
+      // Keep as many jobs going as allowed
+      while (next < m_jobs.size() && LtInt32(running.size()) < m_max_processes)
+      {
+         Job& job = m_jobs[next++];
+
+         // CreateProcess may modify the command line
+         std::wstring command = L"\"" + std::wstring(exe) + L"\" " + job.arguments;
+         std::vector<wchar_t> buffer(command.begin(), command.end());
+         buffer.push_back(0);
+
+         STARTUPINFOW startup;
+         ZeroMemory(&startup, sizeof(startup));
+         startup.cb = sizeof(startup);
+         PROCESS_INFORMATION process;
+
+         if (!CreateProcessW(NULL, &buffer[0], NULL, NULL, FALSE, 0, NULL, NULL,
+                             &startup, &process))
+         {
+            ok = false;
+            continue;
+         }
+
+         CloseHandle(process.hThread);
+         running.push_back(process.hProcess);
+         running_jobs.push_back(next - 1);
+         started.push_back(Clock::now());
+      }
+
+      if (running.empty())
+         break;
+
+      DWORD result = WaitForMultipleObjects(DWORD(running.size()), &running[0], FALSE, INFINITE);
+      if (result >= WAIT_OBJECT_0 + running.size())
+      {
+         // Can't wait, give up on everything still running
+         for (size_t i = 0; i < running.size(); i++)
+         {
+            TerminateProcess(running[i], 1);
+            CloseHandle(running[i]);
+         }
+         return false;
+      }
+
+      size_t done = result - WAIT_OBJECT_0;
+      DWORD exit_code = 1;
+      GetExitCodeProcess(running[done], &exit_code);
+      CloseHandle(running[done]);
+
+      Job& job = m_jobs[running_jobs[done]];
+      job.exit_code = LtInt32(exit_code);
+      job.seconds = std::chrono::duration<LtFloat>(Clock::now() - started[done]).count();
+      if (exit_code != 0)
+         ok = false;
+
+      running.erase(running.begin() + done);
+      running_jobs.erase(running_jobs.begin() + done);
+      started.erase(started.begin() + done);
+   }
+
+   return ok;
+}
@@ -0,0 +1,72 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef PROCESSPOOL_HDR
+#define PROCESSPOOL_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Runs jobs as child processes of the current executable, a limited
+// number at a time. Each job is the executable run again with its own
+// arguments, so one converter can act as both driver and worker. Each
+// process has its own NWcreate session and its own memory.
+class ProcessPool
+{
+public:
+   // At most max_processes jobs run at once, zero for one per processor.
+   ProcessPool(LtInt32 max_processes = 0);
+
+   // Queues a job, returns its index.
+   LtInt32 Add(const std::wstring& arguments);
+
+   // Runs every queued job and waits for them. True if every process
+   // succeeded (exit code zero).
+   bool Run();
+
+   LtInt32 GetNumJobs() const { return LtInt32(m_jobs.size()); }
+   const std::wstring& GetArguments(LtInt32 job) const { return m_jobs[job].arguments; }
+
+   // Exit code of job, -1 if it couldn't be started
+   LtInt32 GetExitCode(LtInt32 job) const { return m_jobs[job].exit_code; }
+
+   // Wall clock time job ran for
+   LtFloat GetSeconds(LtInt32 job) const { return m_jobs[job].seconds; }
+
+private:
+   // Can't copy
+   ProcessPool(const ProcessPool&);
+   ProcessPool& operator= (const ProcessPool&);
+
+   struct Job
+   {
+      std::wstring arguments;
+      LtInt32 exit_code;
+      LtFloat seconds;
+   };
+
+   LtInt32 m_max_processes;
+   std::vector<Job> m_jobs;
+};
+
+#endif // PROCESSPOOL_HDR
@@ -0,0 +1,256 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "PropertyTable.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static LtInt64
+double_cell(LtFloat value)
+{
+   LtInt64 cell;
+   memcpy(&cell, &value, sizeof(cell));
+   return cell;
+}
+
+static LtFloat
+cell_double(LtInt64 cell)
+{
+   LtFloat value;
+   memcpy(&value, &cell, sizeof(value));
+   return value;
+}
+
+size_t
+PropertyTable::RowHash::operator() (const Row& row) const
+{
+   LtNat64 h = 14695981039346656037ULL;
+   for (size_t i = 0; i < row.size(); i++)
+   {
+      h ^= LtNat64(row[i]);
+      h *= 1099511628211ULL;
+   }
+   return size_t(h);
+}
+
+PropertyTable::PropertyTable()
+   : m_num_rows(0),
+     m_schema(NULL),
+     m_num_attached(0)
+{
+}
+
+LtInt32
+PropertyTable::AddField(const char* id, FieldType type, LtNwcSchemaUnitGroup unit_group,
+                        LtInt64 default_cell)
+{
+   Field field;
+   field.id = id;
+   field.type = type;
+   field.unit_group = unit_group;
+   field.default_cell = default_cell;
+   m_fields.push_back(field);
+   m_columns.push_back(std::vector<LtInt64>());
+   return LtInt32(m_fields.size() - 1);
+}
+
+LtInt32
+PropertyTable::AddDoubleField(const char* id, LtNwcSchemaUnitGroup unit_group, LtFloat default_value)
+{
+   return AddField(id, eDOUBLE, unit_group, double_cell(default_value));
+}
+
+LtInt32
+PropertyTable::AddInt32Field(const char* id, LtInt32 default_value)
+{
+   return AddField(id, eINT32, LI_NWC_SCHEMA_UNIT_GROUP_NONE, default_value);
+}
+
+LtInt32
+PropertyTable::AddBooleanField(const char* id, bool default_value)
+{
+   return AddField(id, eBOOLEAN, LI_NWC_SCHEMA_UNIT_GROUP_NONE, default_value ? 1 : 0);
+}
+
+LtInt32
+PropertyTable::AddWideStringField(const char* id, LtWideString default_value)
+{
+   return AddField(id, eWIDE_STRING, LI_NWC_SCHEMA_UNIT_GROUP_NONE, m_strings.Add(default_value));
+}
+
+LtInt32
+PropertyTable::AddRow()
+{
+   for (size_t i = 0; i < m_fields.size(); i++)
+      m_columns[i].push_back(m_fields[i].default_cell);
+   return m_num_rows++;
+}
+
+void
+PropertyTable::SetDouble(LtInt32 row, LtInt32 field, LtFloat value)
+{
+   Set(row, field, double_cell(value));
+}
+
+void
+PropertyTable::SetInt32(LtInt32 row, LtInt32 field, LtInt32 value)
+{
+   Set(row, field, value);
+}
+
+void
+PropertyTable::SetBoolean(LtInt32 row, LtInt32 field, bool value)
+{
+   Set(row, field, value ? 1 : 0);
+}
+
+void
+PropertyTable::SetWideString(LtInt32 row, LtInt32 field, LtWideString value)
+{
+   Set(row, field, m_strings.Add(value));
+}
+
+LtNwcSchema
+PropertyTable::GetSchema()
+{
+   if (m_schema)
+      return m_schema;
+
+   // Builder is consumed by LiNwcSchemaCreate
+   LtNwcSchemaBuilder builder = LiNwcSchemaBuilderCreate();
+   for (size_t i = 0; i < m_concepts.size(); i++)
+      LiNwcSchemaBuilderAddConcept(builder, m_concepts[i].c_str());
+
+   for (size_t i = 0; i < m_fields.size(); i++)
+   {
+      const Field& field = m_fields[i];
+      LtString id = const_cast<LtString>(field.id.c_str());
+
+      switch (field.type)
+      {
+      case eDOUBLE:
+      {
+         LcNwcSchemaDoubleField double_field(id);
+         double_field.SetDefaultValue(cell_double(field.default_cell));
+         double_field.SetUnitGroup(field.unit_group);
+         double_field.SetDisplayNameId(id);
+         LiNwcSchemaBuilderAddField(builder, double_field);
+         break;
+      }
+
+      case eINT32:
+      {
+         LcNwcSchemaInt32Field int32_field(id);
+         int32_field.SetDefaultValue(LtInt32(field.default_cell));
+         int32_field.SetDisplayNameId(id);
+         LiNwcSchemaBuilderAddField(builder, int32_field);
+         break;
+      }
+
+      case eBOOLEAN:
+      {
+         LcNwcSchemaBooleanField boolean_field(id);
+         boolean_field.SetDefaultValue(field.default_cell != 0);
+         boolean_field.SetDisplayNameId(id);
+         LiNwcSchemaBuilderAddField(builder, boolean_field);
+         break;
+      }
+
+      case eWIDE_STRING:
+      {
+         LcNwcSchemaWideStringField string_field(id);
+         string_field.SetDefaultValue(m_strings.Get(StringPool::Id(field.default_cell)));
+         string_field.SetDisplayNameId(id);
+         LiNwcSchemaBuilderAddField(builder, string_field);
+         break;
+      }
+      }
+   }
+
+   m_schema = LiNwcSchemaCreate(builder);
+   return m_schema;
+}
+
+LcNwcAttribute
+PropertyTable::CreateAttribute(const Row& row)
+{
+   LcNwcSchemaPropertyAttribute attribute(GetSchema());
+   if (!m_user_name.empty())
+      attribute.SetClassName(m_user_name.c_str(), m_internal_name.c_str());
+
+   // Defaults come from the schema, only set what differs
+   for (size_t i = 0; i < m_fields.size(); i++)
+   {
+      const Field& field = m_fields[i];
+      if (row[i] == field.default_cell)
+         continue;
+
+      LtString id = const_cast<LtString>(field.id.c_str());
+      switch (field.type)
+      {
+      case eDOUBLE:
+         attribute.SetDouble(id, cell_double(row[i]));
+         break;
+
+      case eINT32:
+         attribute.SetInt32(id, LtInt32(row[i]));
+         break;
+
+      case eBOOLEAN:
+         attribute.SetBoolean(id, row[i] != 0);
+         break;
+
+      case eWIDE_STRING:
+         attribute.SetWideString(id, m_strings.Get(StringPool::Id(row[i])));
+         break;
+      }
+   }
+
+   return attribute;
+}
+
+void
+PropertyTable::Attach(LcNwcNode& node, LtInt32 row)
+{
+   Row values(m_fields.size());
+   for (size_t i = 0; i < m_fields.size(); i++)
+      values[i] = m_columns[i][row];
+
+   std::unordered_map<Row, LtInt32, RowHash>::iterator it = m_shared.find(values);
+   if (it == m_shared.end())
+   {
+      m_attributes.push_back(CreateAttribute(values));
+      it = m_shared.insert(std::make_pair(values, LtInt32(m_attributes.size() - 1))).first;
+   }
+
+   node.AddAttribute(m_attributes[it->second]);
+   m_num_attached++;
+}
+
+std::wstring
+PropertyTable::GetStatistics() const
+{
+   wchar_t buffer[128];
+   swprintf(buffer, 128, L"Properties: %d nodes, %d attributes, %d fields",
+            m_num_attached, GetNumAttributes(), GetNumFields());
+   return buffer;
+}
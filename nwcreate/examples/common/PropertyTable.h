@@ -0,0 +1,134 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef PROPERTYTABLE_HDR
+#define PROPERTYTABLE_HDR
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "StringPool.h"
+
+// Properties for many nodes held as a table: one schema of typed fields,
+// shared by every row, and one column of values per field.
+//
+// Attaching a row creates an LcNwcSchemaPropertyAttribute and sets only the
+// fields that differ from their defaults. Rows with the same values share
+// one attribute, so elements with the same type properties reference a
+// single attribute rather than each building its own set of LcNwcData
+// values with AddProperty.
+//
+// Fields must all be added before the first row.
+class PropertyTable
+{
+public:
+   PropertyTable();
+
+   // Schema. Each returns the field index used to set values. Ids are the
+   // internal names, also used to look up display names.
+   LtInt32 AddDoubleField(const char* id, LtNwcSchemaUnitGroup unit_group = LI_NWC_SCHEMA_UNIT_GROUP_NONE,
+                          LtFloat default_value = 0);
+   LtInt32 AddInt32Field(const char* id, LtInt32 default_value = 0);
+   LtInt32 AddBooleanField(const char* id, bool default_value = false);
+   LtInt32 AddWideStringField(const char* id, LtWideString default_value = L"");
+
+   // Concept describing what the rows are, e.g. L"Column"
+   void AddConcept(LtWideString concept) { m_concepts.push_back(concept); }
+
+   // Class name of the attributes, shown as the property tab name
+   void SetClassName(LtWideString user_name, const char* internal_name)
+   { m_user_name = user_name; m_internal_name = internal_name; }
+
+   LtInt32 GetNumFields() const { return LtInt32(m_fields.size()); }
+
+   // Adds a row with every field at its default and returns its index
+   LtInt32 AddRow();
+   LtInt32 GetNumRows() const { return m_num_rows; }
+
+   void SetDouble(LtInt32 row, LtInt32 field, LtFloat value);
+   void SetInt32(LtInt32 row, LtInt32 field, LtInt32 value);
+   void SetBoolean(LtInt32 row, LtInt32 field, bool value);
+   void SetWideString(LtInt32 row, LtInt32 field, LtWideString value);
+
+   // Attaches properties of row to node
+   void Attach(LcNwcNode& node, LtInt32 row);
+
+   LtInt32 GetNumAttached() const { return m_num_attached; }
+   LtInt32 GetNumAttributes() const { return LtInt32(m_attributes.size()); }
+
+   // "Properties: N nodes, M attributes, F fields"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   PropertyTable(const PropertyTable&);
+   PropertyTable& operator= (const PropertyTable&);
+
+   enum FieldType
+   {
+      eDOUBLE,
+      eINT32,
+      eBOOLEAN,
+      eWIDE_STRING
+   };
+
+   struct Field
+   {
+      std::string id;
+      FieldType type;
+      LtNwcSchemaUnitGroup unit_group;
+      LtInt64 default_cell;
+   };
+
+   // Every value is kept as a 64 bit cell: doubles by bit pattern, strings
+   // by StringPool Id.
+   typedef std::vector<LtInt64> Row;
+
+   struct RowHash
+   {
+      size_t operator() (const Row& row) const;
+   };
+
+   LtInt32 AddField(const char* id, FieldType type, LtNwcSchemaUnitGroup unit_group,
+                    LtInt64 default_cell);
+   void Set(LtInt32 row, LtInt32 field, LtInt64 cell) { m_columns[field][row] = cell; }
+   LtNwcSchema GetSchema();
+   LcNwcAttribute CreateAttribute(const Row& row);
+
+   std::vector<Field> m_fields;
+   std::vector<std::wstring> m_concepts;
+   std::wstring m_user_name;
+   std::string m_internal_name;
+   std::vector<std::vector<LtInt64> > m_columns;
+   LtInt32 m_num_rows;
+   StringPool m_strings;
+
+   LtNwcSchema m_schema;                  // NULL until first attached
+   std::unordered_map<Row, LtInt32, RowHash> m_shared;
+   std::vector<LcNwcAttribute> m_attributes;
+   LtInt32 m_num_attached;
+};
+
+#endif // PROPERTYTABLE_HDR
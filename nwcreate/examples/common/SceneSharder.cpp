@@ -0,0 +1,132 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "SceneSharder.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+SceneSharder::SceneSharder(LtInt32 max_processes)
+   : m_processes(max_processes)
+{
+}
+
+void
+SceneSharder::AddShard(const std::wstring& pathname, const std::wstring& arguments)
+{
+   m_pathnames.push_back(pathname);
+   m_processes.Add(arguments);
+}
+
+bool
+SceneSharder::Run()
+{
+   return m_processes.Run();
+}
+
+LtNwcWriteStatus
+SceneSharder::WriteMaster(LtWideString orig_filename, LtWideString pathname) const
+{
+   return WriteMaster(m_pathnames, orig_filename, pathname);
+}
+
+LtNwcWriteStatus
+SceneSharder::WriteMaster(const std::vector<std::wstring>& shard_pathnames,
+                          LtWideString orig_filename, LtWideString pathname)
+{
+   LcNwcScene scene;
+
+   for (size_t i = 0; i < shard_pathnames.size(); i++)
+   {
+      wchar_t full_path[_MAX_PATH];
+      if (!_wfullpath(full_path, shard_pathnames[i].c_str(), _MAX_PATH))
+         wcscpy_s(full_path, shard_pathnames[i].c_str());
+
+      wchar_t name[_MAX_FNAME];
+      _wsplitpath_s(full_path, NULL, 0, NULL, 0, name, _MAX_FNAME, NULL, 0);
+
+      LcNwcGroup group;
+      group.SetName(name);
+      LcNwcXRefAttribute xref(full_path);
+      group.AddAttribute(xref);
+      scene.AddNode(group);
+
+      // Master is recached if a shard changes
+      scene.DescribeXRef(full_path, full_path);
+   }
+
+   return scene.WriteCache(orig_filename, pathname, NULL, NULL);
+}
+
+//
+// Partitioning
+//
+
+// Spreads the low 21 bits of v out to every third bit
+static LtNat64
+spread_bits(LtNat64 v)
+{
+   v &= 0x1fffff;
+   v = (v | v << 32) & 0x1f00000000ffffULL;
+   v = (v | v << 16) & 0x1f0000ff0000ffULL;
+   v = (v | v << 8) & 0x100f00f00f00f00fULL;
+   v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+   v = (v | v << 2) & 0x1249249249249249ULL;
+   return v;
+}
+
+void
+SceneSharder::Partition(const std::vector<LtFloat>& centers, LtInt32 num_shards,
+                        std::vector<LtInt32>& shards)
+{
+   size_t num_items = centers.size() / 3;
+   shards.assign(num_items, 0);
+   if (num_items == 0 || num_shards <= 1)
+      return;
+
+   LtPoint min, max;
+   for (int k = 0; k < 3; k++)
+   {
+      min[k] = max[k] = centers[k];
+      for (size_t i = 1; i < num_items; i++)
+      {
+         min[k] = std::min(min[k], centers[i * 3 + k]);
+         max[k] = std::max(max[k], centers[i * 3 + k]);
+      }
+   }
+
+   // Same scale on every axis so shards stay roughly cubic
+   LtFloat extent = std::max(max[0] - min[0], std::max(max[1] - min[1], max[2] - min[2]));
+   LtFloat scale = (extent > 0) ? LtFloat(0x1fffff) / extent : 0;
+
+   std::vector<std::pair<LtNat64, LtInt32> > order(num_items);
+   for (size_t i = 0; i < num_items; i++)
+   {
+      LtNat64 code = 0;
+      for (int k = 0; k < 3; k++)
+         code |= spread_bits(LtNat64((centers[i * 3 + k] - min[k]) * scale)) << k;
+      order[i] = std::make_pair(code, LtInt32(i));
+   }
+   std::sort(order.begin(), order.end());
+
+   // Equal runs along the curve
+   for (size_t i = 0; i < num_items; i++)
+      shards[order[i].second] = LtInt32(i * num_shards / num_items);
+}
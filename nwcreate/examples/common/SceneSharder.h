@@ -0,0 +1,83 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef SCENESHARDER_HDR
+#define SCENESHARDER_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "ProcessPool.h"
+
+// Converts a large model as several shards, each written to its own .nwc
+// file by a separate process, and ties them together with a small master
+// scene that references the shards.
+//
+// Shards are converted by running the current executable again with the
+// arguments given to AddShard, so a converter handles both roles: the
+// parent partitions the model and calls Run, each child builds and writes
+// just its own shard. Each process has its own memory, so peak memory goes
+// with shard size, and the shards are written at the same time.
+class SceneSharder
+{
+public:
+   // At most max_processes shards are converted at once, zero for one per
+   // processor.
+   SceneSharder(LtInt32 max_processes = 0);
+
+   // Adds a shard to be written to pathname by running this executable
+   // with arguments.
+   void AddShard(const std::wstring& pathname, const std::wstring& arguments);
+
+   LtInt32 GetNumShards() const { return LtInt32(m_pathnames.size()); }
+   const std::wstring& GetShardPathname(LtInt32 shard) const { return m_pathnames[shard]; }
+
+   // Exit codes and timings of the shard processes
+   const ProcessPool& GetProcesses() const { return m_processes; }
+
+   // Converts every shard and waits for them. True if every process
+   // succeeded (exit code zero).
+   bool Run();
+
+   // Writes a scene with one XRef node per shard, for standalone converters.
+   // As LcNwcScene::WriteCache, the master is a cache of orig_filename, so
+   // it stays valid for as long as the source file is unchanged.
+   LtNwcWriteStatus WriteMaster(LtWideString orig_filename, LtWideString pathname) const;
+   static LtNwcWriteStatus WriteMaster(const std::vector<std::wstring>& shard_pathnames,
+                                       LtWideString orig_filename, LtWideString pathname);
+
+   // Assigns items to num_shards spatially compact shards of near equal
+   // size, by cutting the Morton order of their centers (x, y, z per item).
+   static void Partition(const std::vector<LtFloat>& centers, LtInt32 num_shards,
+                         std::vector<LtInt32>& shards);
+
+private:
+   // Can't copy
+   SceneSharder(const SceneSharder&);
+   SceneSharder& operator= (const SceneSharder&);
+
+   std::vector<std::wstring> m_pathnames;
+   ProcessPool m_processes;
+};
+
+#endif // SCENESHARDER_HDR
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "StringPool.h"
+
+#include <string.h>
+#include <wchar.h>
+
+// FNV-1a over the characters
+template <class C>
+static LtNat32
+hash_string(const C* str, size_t length)
+{
+   LtNat32 h = 2166136261u;
+   for (size_t i = 0; i < length; i++)
+   {
+      h ^= LtNat32(str[i]);
+      h *= 16777619u;
+   }
+   return h;
+}
+
+StringPool::StringPool()
+   : m_arena(64 * 1024)
+{
+}
+
+StringPool::Id
+StringPool::Add(const wchar_t* str)
+{
+   return Add(m_wide, str, wcslen(str));
+}
+
+StringPool::Id
+StringPool::Add(const wchar_t* str, size_t length)
+{
+   return Add(m_wide, str, length);
+}
+
+StringPool::Id
+StringPool::AddInternal(const char* str)
+{
+   return Add(m_internal, str, strlen(str));
+}
+
+template <class C>
+StringPool::Id
+StringPool::Add(Table<C>& table, const C* str, size_t length)
+{
+   // Keep load under a half
+   if (table.strings.size() * 2 >= table.slots.size())
+      Grow(table);
+
+   LtNat32 hash = hash_string(str, length);
+   size_t mask = table.slots.size() - 1;
+   for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+   {
+      Id id = table.slots[slot];
+      if (id < 0)
+      {
+         C* copy = static_cast<C*>(m_arena.Allocate((length + 1) * sizeof(C), sizeof(C)));
+         memcpy(copy, str, length * sizeof(C));
+         copy[length] = 0;
+
+         id = Id(table.strings.size());
+         table.strings.push_back(copy);
+         table.lengths.push_back(LtInt32(length));
+         table.hashes.push_back(hash);
+         table.slots[slot] = id;
+         return id;
+      }
+
+      if (table.hashes[id] == hash && size_t(table.lengths[id]) == length &&
+          !memcmp(table.strings[id], str, length * sizeof(C)))
+         return id;
+   }
+}
+
+template <class C>
+void
+StringPool::Grow(Table<C>& table)
+{
+   size_t size = table.slots.empty() ? 256 : table.slots.size() * 2;
+   table.slots.assign(size, -1);
+
+   size_t mask = size - 1;
+   for (size_t id = 0; id < table.strings.size(); id++)
+   {
+      size_t slot = table.hashes[id] & mask;
+      while (table.slots[slot] >= 0)
+         slot = (slot + 1) & mask;
+      table.slots[slot] = Id(id);
+   }
+}
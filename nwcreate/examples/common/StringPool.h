@@ -0,0 +1,94 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef STRINGPOOL_HDR
+#define STRINGPOOL_HDR
+#pragma once
+
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "GeometryArena.h"
+
+// Interns the strings given to NWcreate as attribute names, class names,
+// property keys and string property values.
+//
+// Converters pass the same few hundred class names and property keys for
+// millions of nodes. Each distinct string is stored once, null terminated,
+// in an arena and never moves, so an Id or pointer from the pool stays
+// valid for the life of the pool. Looking up an Id is an array index, so
+// hot loops should add their strings up front and keep the Ids.
+//
+// NWcreate still copies what it is given, the pool saves the temporary
+// strings and conversions on the converter side. Names made per node, such
+// as "Column 12", are better formatted into a stack buffer and passed
+// straight to NWcreate.
+class StringPool
+{
+public:
+   typedef LtInt32 Id;
+
+   StringPool();
+
+   // Id of str, adding a copy if it hasn't been seen. Ids are dense from zero.
+   Id Add(const wchar_t* str);
+   Id Add(const wchar_t* str, size_t length);
+
+   // Same for internal (narrow) names, which have their own Ids.
+   Id AddInternal(const char* str);
+
+   LtWideString Get(Id id) const { return m_wide.strings[id]; }
+   const char* GetInternal(Id id) const { return m_internal.strings[id]; }
+
+   LtWideString Intern(const wchar_t* str) { return Get(Add(str)); }
+   const char* InternInternal(const char* str) { return GetInternal(AddInternal(str)); }
+
+   LtInt32 GetNumUnique() const
+   { return LtInt32(m_wide.strings.size() + m_internal.strings.size()); }
+   size_t GetBytesAllocated() const { return m_arena.GetBytesAllocated(); }
+
+private:
+   // Can't copy
+   StringPool(const StringPool&);
+   StringPool& operator= (const StringPool&);
+
+   // Open addressing hash table over strings of one character type
+   template <class C>
+   struct Table
+   {
+      std::vector<const C*> strings;
+      std::vector<LtInt32> lengths;
+      std::vector<LtNat32> hashes;
+      std::vector<Id> slots;              // -1 when empty, size is a power of two
+   };
+
+   template <class C>
+   Id Add(Table<C>& table, const C* str, size_t length);
+   template <class C>
+   void Grow(Table<C>& table);
+
+   GeometryArena m_arena;
+   Table<wchar_t> m_wide;
+   Table<char> m_internal;
+};
+
+#endif // STRINGPOOL_HDR
@@ -0,0 +1,422 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#include "TessellationCache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define         LI_PI                   3.14159265358979323846
+
+// Segments per full turn at a faceting factor of 1
+static const LtInt32 cBASE_SEGMENTS = 16;
+static const LtInt32 cMAX_SEGMENTS = 4096;
+
+//
+// Frames
+//
+
+bool
+TessellationUtil::FrameFromZ(const LtVector dir, LtVector axes[3], LtFloat* length)
+{
+   *length = sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+   if (*length <= 0)
+      return false;
+
+   for (int k = 0; k < 3; k++)
+      axes[2][k] = dir[k] / *length;
+
+   // Start x from the world axis least aligned with z
+   int least = 0;
+   for (int k = 1; k < 3; k++)
+   {
+      if (fabs(axes[2][k]) < fabs(axes[2][least]))
+         least = k;
+   }
+   LtVector seed = { 0, 0, 0 };
+   seed[least] = 1;
+
+   LtFloat d = seed[0] * axes[2][0] + seed[1] * axes[2][1] + seed[2] * axes[2][2];
+   LtFloat len = 0;
+   for (int k = 0; k < 3; k++)
+   {
+      axes[0][k] = seed[k] - d * axes[2][k];
+      len += axes[0][k] * axes[0][k];
+   }
+   len = sqrt(len);
+   for (int k = 0; k < 3; k++)
+      axes[0][k] /= len;
+
+   axes[1][0] = axes[2][1] * axes[0][2] - axes[2][2] * axes[0][1];
+   axes[1][1] = axes[2][2] * axes[0][0] - axes[2][0] * axes[0][2];
+   axes[1][2] = axes[2][0] * axes[0][1] - axes[2][1] * axes[0][0];
+
+   return true;
+}
+
+bool
+TessellationUtil::FrameFromXY(const LtVector x_axis, const LtVector y_axis, LtVector axes[3])
+{
+   LtFloat len = sqrt(x_axis[0] * x_axis[0] + x_axis[1] * x_axis[1] + x_axis[2] * x_axis[2]);
+   if (len <= 0)
+      return false;
+   for (int k = 0; k < 3; k++)
+      axes[0][k] = x_axis[k] / len;
+
+   LtFloat d = y_axis[0] * axes[0][0] + y_axis[1] * axes[0][1] + y_axis[2] * axes[0][2];
+   len = 0;
+   for (int k = 0; k < 3; k++)
+   {
+      axes[1][k] = y_axis[k] - d * axes[0][k];
+      len += axes[1][k] * axes[1][k];
+   }
+   len = sqrt(len);
+   if (len <= 0)
+      return false;
+   for (int k = 0; k < 3; k++)
+      axes[1][k] /= len;
+
+   axes[2][0] = axes[0][1] * axes[1][2] - axes[0][2] * axes[1][1];
+   axes[2][1] = axes[0][2] * axes[1][0] - axes[0][0] * axes[1][2];
+   axes[2][2] = axes[0][0] * axes[1][1] - axes[0][1] * axes[1][0];
+
+   return true;
+}
+
+void
+TessellationUtil::ToLocal(const LtVector axes[3], const LtVector v, LtVector local)
+{
+   for (int i = 0; i < 3; i++)
+      local[i] = axes[i][0] * v[0] + axes[i][1] * v[1] + axes[i][2] * v[2];
+}
+
+//
+// Facet generation, all in local frame
+//
+
+static void
+add_vertex(std::vector<LtFloat>& positions, std::vector<LtFloat>& normals,
+           LtFloat x, LtFloat y, LtFloat z, LtFloat nx, LtFloat ny, LtFloat nz)
+{
+   LtFloat len = sqrt(nx * nx + ny * ny + nz * nz);
+   if (len > 0)
+   {
+      nx /= len;
+      ny /= len;
+      nz /= len;
+   }
+
+   positions.push_back(x); positions.push_back(y); positions.push_back(z);
+   normals.push_back(nx); normals.push_back(ny); normals.push_back(nz);
+}
+
+static void
+add_triangle(std::vector<LtInt32>& triangles, LtInt32 a, LtInt32 b, LtInt32 c)
+{
+   triangles.push_back(a);
+   triangles.push_back(b);
+   triangles.push_back(c);
+}
+
+//
+// TessellationCache
+//
+
+bool
+TessellationCache::Key::operator== (const Key& other) const
+{
+   for (int i = 0; i < cMAX_PARAMS + 3; i++)
+   {
+      if (values[i] != other.values[i])
+         return false;
+   }
+   return true;
+}
+
+size_t
+TessellationCache::KeyHash::operator() (const Key& key) const
+{
+   LtNat64 hash = 14695981039346656037ULL;
+   for (int i = 0; i < cMAX_PARAMS + 3; i++)
+   {
+      hash ^= LtNat64(key.values[i]);
+      hash *= 1099511628211ULL;
+   }
+   return size_t(hash);
+}
+
+TessellationCache::TessellationCache(bool normals, LtFloat tolerance)
+   : m_normals(normals), m_tolerance(tolerance), m_faceting_factor(1),
+     m_max_facet_deviation(0), m_num_hits(0), m_num_misses(0), m_num_bypassed(0)
+{
+}
+
+TessellationCache::~TessellationCache()
+{
+   Clear();
+}
+
+void
+TessellationCache::Clear()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   std::unordered_map<Key, Template*, KeyHash>::iterator it;
+   for (it = m_templates.begin(); it != m_templates.end(); ++it)
+      delete it->second;
+
+   m_templates.clear();
+   m_num_hits = 0;
+   m_num_misses = 0;
+   m_num_bypassed = 0;
+}
+
+void
+TessellationCache::ClearStatistics()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   m_num_hits = 0;
+   m_num_misses = 0;
+   m_num_bypassed = 0;
+}
+
+LtInt32
+TessellationCache::GetNumTemplates() const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return LtInt32(m_templates.size());
+}
+
+LtInt32
+TessellationCache::Segments(LtFloat radius, LtFloat sweep) const
+{
+   LtFloat factor = (m_faceting_factor > 0.01) ? m_faceting_factor : 0.01;
+   LtFloat step = 2 * LI_PI / (cBASE_SEGMENTS * factor);
+
+   if (m_max_facet_deviation > 0 && radius > m_max_facet_deviation)
+   {
+      LtFloat chord_step = 2 * acos(1 - m_max_facet_deviation / radius);
+      if (chord_step < step)
+         step = chord_step;
+   }
+
+   LtFloat n = ceil(sweep / step);
+   LtInt32 min_segments = (sweep >= 2 * LI_PI - 1e-9) ? 3 : 1;
+   if (n < min_segments)
+      return min_segments;
+   if (n > cMAX_SEGMENTS)
+      return cMAX_SEGMENTS;
+   return LtInt32(n);
+}
+
+TessellationCache::Template*
+TessellationCache::Build(PrimitiveType type, const LtFloat* params) const
+{
+   Template* facets = new Template;
+   std::vector<LtFloat>& pos = facets->positions;
+   std::vector<LtFloat>& nrm = facets->normals;
+   std::vector<LtInt32>& tri = facets->triangles;
+
+   switch (type)
+   {
+      case eCIRCLE:
+      {
+         // Disc facing +z
+         LtFloat r = params[0];
+         LtInt32 n = Segments(r, 2 * LI_PI);
+
+         add_vertex(pos, nrm, 0, 0, 0, 0, 0, 1);
+         for (LtInt32 i = 0; i < n; i++)
+         {
+            LtFloat a = 2 * LI_PI * i / n;
+            add_vertex(pos, nrm, r * cos(a), r * sin(a), 0, 0, 0, 1);
+         }
+         for (LtInt32 i = 0; i < n; i++)
+            add_triangle(tri, 0, 1 + i, 1 + (i + 1) % n);
+         break;
+      }
+
+      case eCONIC:
+      {
+         // Elliptical ends in planes parallel to xy, first centered on origin
+         LtFloat a1 = params[0], b1 = params[1], a2 = params[2], b2 = params[3];
+         LtFloat dx = params[4], dy = params[5], dz = params[6];
+         LtFloat start = params[7], sweep = params[8] - params[7];
+         if (sweep <= 0)
+            sweep += 2 * LI_PI;
+
+         LtFloat r = fabs(a1);
+         if (fabs(b1) > r) r = fabs(b1);
+         if (fabs(a2) > r) r = fabs(a2);
+         if (fabs(b2) > r) r = fabs(b2);
+         LtInt32 n = Segments(r, sweep);
+
+         for (LtInt32 i = 0; i <= n; i++)
+         {
+            LtFloat a = start + sweep * i / n;
+            LtFloat c = cos(a), s = sin(a);
+
+            LtFloat p1[3] = { a1 * c, b1 * s, 0 };
+            LtFloat p2[3] = { dx + a2 * c, dy + b2 * s, dz };
+            LtFloat g[3] = { p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2] };
+
+            // Normal is tangent of end ellipse crossed with generator. Use
+            // other end's tangent at a cone apex.
+            LtFloat t1[3] = { -a1 * s, b1 * c, 0 };
+            LtFloat t2[3] = { -a2 * s, b2 * c, 0 };
+            if (t1[0] == 0 && t1[1] == 0)
+               t1[0] = t2[0], t1[1] = t2[1];
+            if (t2[0] == 0 && t2[1] == 0)
+               t2[0] = t1[0], t2[1] = t1[1];
+
+            add_vertex(pos, nrm, p1[0], p1[1], p1[2],
+                       t1[1] * g[2] - t1[2] * g[1], t1[2] * g[0] - t1[0] * g[2],
+                       t1[0] * g[1] - t1[1] * g[0]);
+            add_vertex(pos, nrm, p2[0], p2[1], p2[2],
+                       t2[1] * g[2] - t2[2] * g[1], t2[2] * g[0] - t2[0] * g[2],
+                       t2[0] * g[1] - t2[1] * g[0]);
+         }
+         for (LtInt32 i = 0; i < n; i++)
+         {
+            add_triangle(tri, 2 * i, 2 * i + 2, 2 * i + 1);
+            add_triangle(tri, 2 * i + 2, 2 * i + 3, 2 * i + 1);
+         }
+         break;
+      }
+
+      case eSPHERE:
+      {
+         LtFloat r = params[0];
+         LtInt32 n = Segments(r, 2 * LI_PI);
+         LtInt32 m = (n / 2 > 2) ? n / 2 : 2;
+
+         for (LtInt32 j = 0; j <= m; j++)
+         {
+            LtFloat theta = LI_PI * j / m;
+            for (LtInt32 i = 0; i <= n; i++)
+            {
+               LtFloat phi = 2 * LI_PI * i / n;
+               LtFloat x = sin(theta) * cos(phi), y = sin(theta) * sin(phi), z = cos(theta);
+               add_vertex(pos, nrm, r * x, r * y, r * z, x, y, z);
+            }
+         }
+         for (LtInt32 j = 0; j < m; j++)
+         {
+            for (LtInt32 i = 0; i < n; i++)
+            {
+               LtInt32 a = j * (n + 1) + i, b = a + 1, c = a + n + 1, d = c + 1;
+
+               // Skip triangles that collapse at the poles
+               if (j > 0)
+                  add_triangle(tri, a, c, b);
+               if (j < m - 1)
+                  add_triangle(tri, b, c, d);
+            }
+         }
+         break;
+      }
+
+      case eTORUS:
+      {
+         // Around z, u round the ring and v round the tube
+         LtFloat R = params[0], r = params[1];
+         LtInt32 nu = Segments(R + r, 2 * LI_PI);
+         LtInt32 nv = Segments(r, 2 * LI_PI);
+
+         for (LtInt32 i = 0; i <= nu; i++)
+         {
+            LtFloat u = 2 * LI_PI * i / nu;
+            for (LtInt32 j = 0; j <= nv; j++)
+            {
+               LtFloat v = 2 * LI_PI * j / nv;
+               LtFloat w = R + r * cos(v);
+               add_vertex(pos, nrm, w * cos(u), w * sin(u), r * sin(v),
+                          cos(v) * cos(u), cos(v) * sin(u), sin(v));
+            }
+         }
+         for (LtInt32 i = 0; i < nu; i++)
+         {
+            for (LtInt32 j = 0; j < nv; j++)
+            {
+               LtInt32 a = i * (nv + 1) + j, b = a + nv + 1, c = a + 1, d = b + 1;
+               add_triangle(tri, a, b, c);
+               add_triangle(tri, b, d, c);
+            }
+         }
+         break;
+      }
+   }
+
+   return facets;
+}
+
+// Bit pattern of value rounded to a multiple of 1 / scale. Rounding stays in
+// double precision, so large coordinates can't overflow an integer.
+static LtInt64
+quantize(LtFloat value, LtFloat scale)
+{
+   LtFloat rounded = floor(value * scale + 0.5);
+   if (rounded == 0)
+      rounded = 0;   // No negative zero
+
+   LtInt64 bits;
+   memcpy(&bits, &rounded, sizeof(bits));
+   return bits;
+}
+
+const TessellationCache::Template*
+TessellationCache::Lookup(PrimitiveType type, const LtFloat* params, int num_params)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   LtFloat scale = 1.0 / m_tolerance;
+
+   Key key;
+   key.values[0] = type;
+   key.values[1] = quantize(m_faceting_factor, scale);
+   key.values[2] = quantize(m_max_facet_deviation, scale);
+   for (int i = 0; i < cMAX_PARAMS; i++)
+      key.values[i + 3] = (i < num_params) ? quantize(params[i], scale) : 0;
+
+   std::unordered_map<Key, Template*, KeyHash>::iterator it = m_templates.find(key);
+   if (it != m_templates.end())
+   {
+      m_num_hits++;
+      return it->second;
+   }
+
+   m_num_misses++;
+   Template* facets = Build(type, params);
+   m_templates[key] = facets;
+
+   return facets;
+}
+
+std::wstring
+TessellationCache::GetStatistics() const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   wchar_t buffer[256];
+   swprintf(buffer, 256, L"Tessellation cache: %d primitives, %d faceted, %d bypassed",
+            m_num_hits + m_num_misses + m_num_bypassed, m_num_misses, m_num_bypassed);
+   return buffer;
+}
@@ -0,0 +1,310 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef TESSELLATIONCACHE_HDR
+#define TESSELLATIONCACHE_HDR
+#pragma once
+
+#include <math.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+
+#include <nwcreate/LiNwcAll.h>
+
+// Facets analytic primitives on the client and keeps the facets, so that
+// repeated primitives with the same dimensions are only faceted once.
+//
+// Each primitive is split into a rigid placement (origin and orthonormal
+// axes) and a shape in its own local frame. The shape, together with the
+// current FacetingFactor and MaxFacetDeviation, is the cache key. Cached
+// facets are placed by the rigid transform and written as indexed
+// triangles, so normals stay valid.
+//
+// Segment counts follow the stream settings: FacetingFactor scales a base
+// number of segments per full turn, and MaxFacetDeviation, if set, also
+// bounds the chord error. Unlike the geometry stream primitives, Cylinder
+// and Conic don't cap their ends; use Circle as the stream callers do.
+//
+// Primitive methods must be called between Begin and End on an
+// LcNwcGeometryStream or a GeometryRecorder. They can be called from several
+// threads at once, each with its own stream.
+class TessellationCache
+{
+public:
+   // With normals, the stream must have been begun with LI_NWC_VERTEX_NORMAL.
+   TessellationCache(bool normals = true, LtFloat tolerance = 1e-9);
+   ~TessellationCache();
+
+   // Settings that control faceting, as on the geometry stream
+   void FacetingFactor(LtFloat factor) { m_faceting_factor = factor; }
+   void MaxFacetDeviation(LtFloat tol) { m_max_facet_deviation = tol; }
+
+   template <class Stream> void
+   Circle(Stream& stream, const LtPoint center, const LtUnitVector normal, LtFloat radius);
+   template <class Stream> void
+   Cylinder(Stream& stream, const LtPoint pt1, const LtPoint pt2, LtFloat radius);
+   template <class Stream> void
+   Sphere(Stream& stream, const LtPoint pt, LtFloat radius);
+   template <class Stream> void
+   Torus(Stream& stream, const LtPoint center, const LtVector x_axis, const LtVector y_axis,
+         LtFloat major_radius, LtFloat minor_radius);
+
+   // Conics whose end ellipses are parallel and have perpendicular axes are
+   // cached, any other conic is passed straight to the stream.
+   template <class Stream> void
+   Conic(Stream& stream, const LtPoint pt1, const LtVector major1, const LtVector minor1,
+         const LtPoint pt2, const LtVector major2, const LtVector minor2,
+         LtFloat start_ang=0, LtFloat end_ang=0);
+
+   // Forgets all cached facets
+   void Clear();
+
+   // Zeroes the counts, keeping the cached facets
+   void ClearStatistics();
+
+   LtInt32 GetNumHits() const { return m_num_hits; }
+   LtInt32 GetNumMisses() const { return m_num_misses; }
+   LtInt32 GetNumBypassed() const { return m_num_bypassed; }
+   LtInt32 GetNumTemplates() const;
+
+   // "Tessellation cache: N primitives, M faceted, B bypassed"
+   std::wstring GetStatistics() const;
+
+private:
+   // Can't copy
+   TessellationCache(const TessellationCache&);
+   TessellationCache& operator= (const TessellationCache&);
+
+   enum PrimitiveType
+   {
+      eCIRCLE,
+      eCONIC,
+      eSPHERE,
+      eTORUS
+   };
+
+   enum { cMAX_PARAMS = 9 };
+
+   struct Key
+   {
+      LtInt64 values[cMAX_PARAMS + 3];
+
+      bool operator== (const Key& other) const;
+   };
+
+   struct KeyHash
+   {
+      size_t operator() (const Key& key) const;
+   };
+
+   // Facets in local frame
+   struct Template
+   {
+      std::vector<LtFloat> positions;     // x, y, z per vertex
+      std::vector<LtFloat> normals;       // x, y, z per vertex
+      std::vector<LtInt32> triangles;     // 3 vertex indices per triangle
+   };
+
+   // Rigid placement of local frame
+   struct Placement
+   {
+      LtPoint origin;
+      LtVector axes[3];
+   };
+
+   const Template* Lookup(PrimitiveType type, const LtFloat* params, int num_params);
+   Template* Build(PrimitiveType type, const LtFloat* params) const;
+   LtInt32 Segments(LtFloat radius, LtFloat sweep) const;
+
+   template <class Stream> void
+   Emit(Stream& stream, const Template& facets, const Placement& placement) const;
+
+   bool m_normals;
+   LtFloat m_tolerance;
+   LtFloat m_faceting_factor;
+   LtFloat m_max_facet_deviation;
+
+   mutable std::mutex m_mutex;
+   std::unordered_map<Key, Template*, KeyHash> m_templates;
+   LtInt32 m_num_hits;
+   LtInt32 m_num_misses;
+   LtInt32 m_num_bypassed;
+};
+
+//
+// Template implementation
+//
+
+namespace TessellationUtil
+{
+   // Sets axes to an orthonormal frame with z along dir. False if dir is zero.
+   bool FrameFromZ(const LtVector dir, LtVector axes[3], LtFloat* length);
+
+   // Frame with x along x_axis and y in the plane of x_axis and y_axis
+   bool FrameFromXY(const LtVector x_axis, const LtVector y_axis, LtVector axes[3]);
+
+   // Components of v in frame
+   void ToLocal(const LtVector axes[3], const LtVector v, LtVector local);
+}
+
+template <class Stream> void
+TessellationCache::Emit(Stream& stream, const Template& facets, const Placement& placement) const
+{
+   const LtVector* axes = placement.axes;
+   size_t num_vertices = facets.positions.size() / 3;
+
+   LtInt32 base = -1;
+   for (size_t i = 0; i < num_vertices; i++)
+   {
+      const LtFloat* l = &facets.positions[i * 3];
+
+      if (m_normals)
+      {
+         const LtFloat* n = &facets.normals[i * 3];
+         stream.Normal(axes[0][0] * n[0] + axes[1][0] * n[1] + axes[2][0] * n[2],
+                       axes[0][1] * n[0] + axes[1][1] * n[1] + axes[2][1] * n[2],
+                       axes[0][2] * n[0] + axes[1][2] * n[1] + axes[2][2] * n[2]);
+      }
+
+      LtInt32 index = stream.IndexedVertex(
+         placement.origin[0] + axes[0][0] * l[0] + axes[1][0] * l[1] + axes[2][0] * l[2],
+         placement.origin[1] + axes[0][1] * l[0] + axes[1][1] * l[1] + axes[2][1] * l[2],
+         placement.origin[2] + axes[0][2] * l[0] + axes[1][2] * l[1] + axes[2][2] * l[2]);
+
+      // Indices returned by the stream are consecutive
+      if (i == 0)
+         base = index;
+   }
+
+   for (size_t i = 0; i < facets.triangles.size(); i++)
+      stream.TriangleIndex(base + facets.triangles[i]);
+}
+
+template <class Stream> void
+TessellationCache::Circle(Stream& stream, const LtPoint center, const LtUnitVector normal,
+                          LtFloat radius)
+{
+   Placement placement;
+   LtFloat length;
+   if (!TessellationUtil::FrameFromZ(normal, placement.axes, &length))
+      return;
+   placement.origin[0] = center[0];
+   placement.origin[1] = center[1];
+   placement.origin[2] = center[2];
+
+   LtFloat params[] = { radius };
+   Emit(stream, *Lookup(eCIRCLE, params, 1), placement);
+}
+
+template <class Stream> void
+TessellationCache::Cylinder(Stream& stream, const LtPoint pt1, const LtPoint pt2, LtFloat radius)
+{
+   LtVector dir = { pt2[0] - pt1[0], pt2[1] - pt1[1], pt2[2] - pt1[2] };
+
+   Placement placement;
+   LtFloat length;
+   if (!TessellationUtil::FrameFromZ(dir, placement.axes, &length))
+      return;
+   placement.origin[0] = pt1[0];
+   placement.origin[1] = pt1[1];
+   placement.origin[2] = pt1[2];
+
+   // Same shape as a full circular conic along z
+   LtFloat params[] = { radius, radius, radius, radius, 0, 0, length, 0, 0 };
+   Emit(stream, *Lookup(eCONIC, params, 9), placement);
+}
+
+template <class Stream> void
+TessellationCache::Sphere(Stream& stream, const LtPoint pt, LtFloat radius)
+{
+   Placement placement;
+   for (int i = 0; i < 3; i++)
+   {
+      placement.origin[i] = pt[i];
+      for (int j = 0; j < 3; j++)
+         placement.axes[i][j] = (i == j) ? 1.0 : 0.0;
+   }
+
+   LtFloat params[] = { radius };
+   Emit(stream, *Lookup(eSPHERE, params, 1), placement);
+}
+
+template <class Stream> void
+TessellationCache::Torus(Stream& stream, const LtPoint center, const LtVector x_axis,
+                         const LtVector y_axis, LtFloat major_radius, LtFloat minor_radius)
+{
+   Placement placement;
+   if (!TessellationUtil::FrameFromXY(x_axis, y_axis, placement.axes))
+      return;
+   placement.origin[0] = center[0];
+   placement.origin[1] = center[1];
+   placement.origin[2] = center[2];
+
+   LtFloat params[] = { major_radius, minor_radius };
+   Emit(stream, *Lookup(eTORUS, params, 2), placement);
+}
+
+template <class Stream> void
+TessellationCache::Conic(Stream& stream, const LtPoint pt1, const LtVector major1,
+                         const LtVector minor1, const LtPoint pt2, const LtVector major2,
+                         const LtVector minor2, LtFloat start_ang, LtFloat end_ang)
+{
+   Placement placement;
+   bool cacheable = TessellationUtil::FrameFromXY(major1, minor1, placement.axes);
+
+   LtVector l_major1, l_minor1, l_major2, l_minor2, l_offset;
+   LtVector offset = { pt2[0] - pt1[0], pt2[1] - pt1[1], pt2[2] - pt1[2] };
+   if (cacheable)
+   {
+      TessellationUtil::ToLocal(placement.axes, major1, l_major1);
+      TessellationUtil::ToLocal(placement.axes, minor1, l_minor1);
+      TessellationUtil::ToLocal(placement.axes, major2, l_major2);
+      TessellationUtil::ToLocal(placement.axes, minor2, l_minor2);
+      TessellationUtil::ToLocal(placement.axes, offset, l_offset);
+
+      // Axes must line up with the local frame at both ends
+      LtFloat tol = m_tolerance * (1 + l_major1[0] + l_minor1[1]);
+      cacheable = fabs(l_minor1[0]) <= tol &&
+                  fabs(l_major2[1]) <= tol && fabs(l_major2[2]) <= tol &&
+                  fabs(l_minor2[0]) <= tol && fabs(l_minor2[2]) <= tol;
+   }
+
+   if (!cacheable)
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_num_bypassed++;
+      }
+      stream.Conic(pt1, major1, minor1, pt2, major2, minor2, start_ang, end_ang);
+      return;
+   }
+
+   placement.origin[0] = pt1[0];
+   placement.origin[1] = pt1[1];
+   placement.origin[2] = pt1[2];
+
+   LtFloat params[] = { l_major1[0], l_minor1[1], l_major2[0], l_minor2[1],
+                        l_offset[0], l_offset[1], l_offset[2], start_ang, end_ang };
+   Emit(stream, *Lookup(eCONIC, params, 9), placement);
+}
+
+#endif // TESSELLATIONCACHE_HDR
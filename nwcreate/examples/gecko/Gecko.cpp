@@ -21,6 +21,9 @@
 #include <nwcreate/LiNwcAll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string>
+
+#include "MaterialPool.h"
 
 #define LI_NWC_NO_PROGRESS_CALLBACKS NULL
 #define LI_NWC_NO_USER_DATA NULL
@@ -250,27 +253,14 @@ do_test()
    geom_exhaust.SetClassName(L"Part","Space CAD Ship Part");
    geom_burner.SetClassName(L"Exhaust Fumes", "Space CAD Ship Part");
 
-   LcNwcMaterial top_material;
-   //Set ambient and diffuse color so that the color will remain whatever the lighting is
-   top_material.SetDiffuseColor(0.9,0.9,0.9);
-   top_material.SetAmbientColor(0.9,0.9,0.9);
-   //Set the colour for the whole group and everything inside it
-   geom_top.AddAttribute(top_material);
-   
-   LcNwcMaterial bottom_material;
-   bottom_material.SetDiffuseColor(0.5,0.5,0.5);
-   bottom_material.SetAmbientColor(0.5,0.5,0.5);
-   geom_bottom.AddAttribute(bottom_material);
+   //Parts of the same colour share one material attribute
+   MaterialPool materials;
 
-   LcNwcMaterial rear_material;
-   rear_material.SetDiffuseColor(1,0,0);
-   rear_material.SetAmbientColor(1,0,0);
-   geom_rear.AddAttribute(rear_material);
-
-   LcNwcMaterial exhaust_material;
-   exhaust_material.SetDiffuseColor(1,0.1,0.1);
-   exhaust_material.SetAmbientColor(1,0.1,0.1);
-   geom_exhaust.AddAttribute(exhaust_material);
+   //Set ambient and diffuse color so that the color will remain whatever the lighting is
+   geom_top.AddAttribute(materials.GetColor(0.9,0.9,0.9));
+   geom_bottom.AddAttribute(materials.GetColor(0.5,0.5,0.5));
+   geom_rear.AddAttribute(materials.GetColor(1,0,0));
+   geom_exhaust.AddAttribute(materials.GetColor(1,0.1,0.1));
 
    LcNwcGeometryStream stream_gecko_top = geom_top.OpenStream();
    LcNwcGeometryStream stream_gecko_bottom = geom_bottom.OpenStream();
@@ -416,8 +406,10 @@ do_test()
    scene.AddSavedView(army_view);
 
    // Add some detail to scene statistics dialog in NavisWorks
-   scene.SetStatistics(
-      L"Converted 5 Parts\nConverted 1 Ship\nConverted 9 Instances");
+   std::wstring statistics =
+      L"Converted 5 Parts\nConverted 1 Ship\nConverted 9 Instances\n";
+   statistics += materials.GetStatistics();
+   scene.SetStatistics(statistics.c_str());
 
    //Save the NavisWorks file
    scene.WriteCache(L"", L"gecko.nwc", LI_NWC_NO_PROGRESS_CALLBACKS, LI_NWC_NO_USER_DATA);
@@ -27,6 +27,10 @@ static char rcsid[] = "@(#)$Id: //NavisWorks/release/19.0/Api/nwcreate/examples/
 #include <windows.h>
 
 #include <nwcreate/LiNwcAll.h>
+#include "GeometryRecorder.h"
+#include "MeshDecimator.h"
+#include "FragmentTuner.h"
+#include "FileSniffer.h"
 
 // Useful constant
 #define         LI_PI                   3.14159265358979323846
@@ -35,6 +39,9 @@ static char rcsid[] = "@(#)$Id: //NavisWorks/release/19.0/Api/nwcreate/examples/
 static LtFloat f_faceting_factor = 1;
 static LtFloat f_max_facet_deviation = 0;
 static LtBoolean f_make_cylinder = TRUE;
+static LtFloat f_mesh_max_error = 0;
+static LtInt32 f_fragment_size = 0;
+static LtBoolean f_recenter_geometry = FALSE;
 
 // Specification of widget read from file
 struct WidgetSpec
@@ -43,6 +50,12 @@ struct WidgetSpec
    LtFloat outer_radius;
    LtFloat arm_length;
    LtFloat thickness;
+
+   // Optional triangle mesh attached to widget
+   MeshDecimator mesh;
+
+   // Widget geometry, recorded once at load time
+   GeometryRecorder recorder;
 };
 
 // Deletes any data needed by geometry callbacks when done
@@ -94,14 +107,12 @@ vec_scale(LtVector c, const LtVector a, LtFloat b)
    c[2] = a[2] * b;
 }
 
-static LtBoolean LI_NWC_API
-geometry_cb(LtNwcGeometry geometry, 
-            LtNwcGeometryStream stream_handle, 
-            void* user_data)
+// Defines widget geometry. Templated so that it can be written directly to
+// an LcNwcGeometryStream or captured in a GeometryRecorder.
+template <class Stream>
+static void
+define_widget(Stream& stream, WidgetSpec* spec)
 {
-   LcNwcGeometryStream stream(stream_handle);
-   WidgetSpec* spec = static_cast<WidgetSpec*>(user_data);
-
    // Usefull base vectors
    LtPoint c = { 0, 0, 0 };
    LtUnitVector x = { 1, 0, 0};
@@ -297,6 +308,18 @@ geometry_cb(LtNwcGeometry geometry,
    stream.End();
 
 
+   //
+   // Mesh supplied with the widget, already simplified to the error
+   // requested in the loader parameters. Normals are generated.
+   //
+   if (spec->mesh.GetNumTriangles() > 0)
+   {
+      stream.Begin(LI_NWC_VERTEX_NONE);
+      spec->mesh.Emit(stream);
+      stream.End();
+   }
+
+
    //
    // Cylinder "held" by widget to show that exterior faceting of
    // inner widget surface means no intersection with cylinder of
@@ -321,7 +344,30 @@ geometry_cb(LtNwcGeometry geometry,
       stream.Circle(c2, z, spec->inner_radius);
       stream.End();
    }
-   
+}
+
+// Replays widget geometry recorded by load_file_cb
+static LtBoolean LI_NWC_API
+geometry_cb(LtNwcGeometry geometry, 
+            LtNwcGeometryStream stream_handle, 
+            void* user_data)
+{
+   LcNwcGeometryStream stream(stream_handle);
+   WidgetSpec* spec = static_cast<WidgetSpec*>(user_data);
+
+   // Fragment thresholds to suit the recorded geometry, if asked for
+   if (f_fragment_size > 0)
+   {
+      FragmentTuner tuner(f_fragment_size);
+      tuner.Tune(spec->recorder).Apply(stream);
+   }
+
+   // Stream far off geometry relative to a local origin, in double precision
+   if (f_recenter_geometry)
+      spec->recorder.ReplayRecentered(stream);
+   else
+      spec->recorder.Replay(stream);
+
    return TRUE;
 }
 
@@ -337,9 +383,41 @@ parse_file(FILE* fp, WidgetSpec* spec)
    if (fscanf_s(fp, "%lg", &spec->thickness) != 1)
       return FALSE;
 
+   // Optional mesh: vertex and triangle counts, then x y z for each vertex
+   // and three vertex indices for each triangle.
+   LtInt32 num_vertices, num_triangles;
+   if (fscanf_s(fp, "%d %d", &num_vertices, &num_triangles) != 2)
+      return TRUE;
+
+   for (LtInt32 i = 0; i < num_vertices; i++)
+   {
+      LtPoint p;
+      if (fscanf_s(fp, "%lg %lg %lg", &p[0], &p[1], &p[2]) != 3)
+         return FALSE;
+      spec->mesh.AddVertex(p[0], p[1], p[2]);
+   }
+
+   for (LtInt32 i = 0; i < num_triangles; i++)
+   {
+      LtInt32 a, b, c;
+      if (fscanf_s(fp, "%d %d %d", &a, &b, &c) != 3)
+         return FALSE;
+      spec->mesh.AddTriangle(a, b, c);
+   }
+
    return TRUE;
 }
 
+// Widget files are all numbers, starting with the four widget dimensions.
+static bool
+sniff_file(const char* data, size_t size, bool truncated)
+{
+   std::string text = FileSniffer::GetText(data, size, truncated);
+   return FileSniffer::CountNumbers(text, 0) >= 4;
+}
+
+static FileSniffer f_sniffer(&sniff_file);
+
 static LtNwcLoadStatus LI_NWC_API 
 load_file_cb(LtNwcLoader loader_handle,
              LtWideString pathname, 
@@ -361,6 +439,15 @@ load_file_cb(LtNwcLoader loader_handle,
    options.GetOption("make_cylinder", value);
    f_make_cylinder = value.GetBoolean();
 
+   options.GetOption("mesh_max_error", value);
+   f_mesh_max_error = value.GetFloat();
+
+   options.GetOption("fragment_size", value);
+   f_fragment_size = value.GetInt32();
+
+   options.GetOption("recenter_geometry", value);
+   f_recenter_geometry = value.GetBoolean();
+
    FILE* fp = NULL;
    _wfopen_s(&fp, pathname, L"r");
    if (!fp)
@@ -375,6 +462,12 @@ load_file_cb(LtNwcLoader loader_handle,
 
    (*progress)(0, progress_data);
 
+   // Simplify mesh before any triangles are emitted
+   spec->mesh.Simplify(f_mesh_max_error);
+
+   // Build geometry up front, independently of any geometry stream
+   define_widget(spec->recorder, spec);
+
    LcNwcScene scene(scene_handle);
 
    LcNwcGeometry geom;
@@ -419,6 +512,15 @@ define_options_cb(LtNwcLoader loader, LtNwcOptionSet option_set, void *user_data
 
    value.SetBoolean(TRUE);
    opts.DefineOption("make_cylinder", value);
+
+   value.SetFloat(0.0);
+   opts.DefineOption("mesh_max_error", value);
+
+   value.SetInt32(0);
+   opts.DefineOption("fragment_size", value);
+
+   value.SetBoolean(FALSE);
+   opts.DefineOption("recenter_geometry", value);
 }
 
 // Entry point for loader. Setup callbacks for loading from file and
@@ -427,6 +529,7 @@ extern "C" __declspec(dllexport) LtBoolean LI_NWC_API
 LiNwcLoaderEntry(LtNwcLoader loader_handle)
 {
    LcNwcLoader loader(loader_handle);
+   loader.SetUnderstandsFileExCallback(&FileSniffer::UnderstandsFileExCallback, &f_sniffer);
    loader.SetLoadFileCallback(&load_file_cb, NULL);
    loader.SetDefineOptionsCallback(&define_options_cb, NULL);
 
@@ -0,0 +1,181 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#include "ColumnBinary.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "GuidBatch.h"
+
+static const char cMAGIC[4] = { 'M', 'L', 'B', '1' };
+static const LtNat32 cVERSION = 1;
+
+struct ColumnBinaryHeader
+{
+   char magic[4];
+   LtNat32 version;
+   LtNat64 num_rows;
+   LtInt64 source_size;
+   LtInt64 source_write_time;
+   LtNat8 reserved[32];
+};
+
+// Columns follow at 8 byte alignment
+static_assert(sizeof(ColumnBinaryHeader) == 64, "Header must be 64 bytes");
+
+static const size_t cROW_BYTES = 4 * sizeof(LtFloat) + 16;
+
+ColumnBinary::ColumnBinary()
+   : m_num_rows(0),
+     m_guids(NULL)
+{
+   for (int k = 0; k < 4; k++)
+      m_columns[k] = NULL;
+}
+
+std::wstring
+ColumnBinary::GetCompanionPathname(LtWideString source)
+{
+   std::wstring pathname = source;
+   size_t dot = pathname.rfind(L'.');
+   if (dot != std::wstring::npos && pathname.find_first_of(L"\\/", dot) == std::wstring::npos)
+      pathname.erase(dot);
+   return pathname + L".mlb";
+}
+
+bool
+ColumnBinary::Open(LtWideString pathname, LtWideString source)
+{
+   Close();
+
+   FileStamp stamp;
+   if (!FileStamp::Get(source, stamp) || !m_file.Open(pathname))
+      return false;
+
+   const ColumnBinaryHeader* header = reinterpret_cast<const ColumnBinaryHeader*>(m_file.GetData());
+   size_t size = m_file.GetSize();
+   if (size < sizeof(ColumnBinaryHeader) ||
+       memcmp(header->magic, cMAGIC, sizeof(cMAGIC)) != 0 ||
+       header->version != cVERSION ||
+       header->source_size != stamp.size ||
+       header->source_write_time != stamp.write_time ||
+       header->num_rows != (size - sizeof(ColumnBinaryHeader)) / cROW_BYTES ||
+       size != sizeof(ColumnBinaryHeader) + header->num_rows * cROW_BYTES)
+   {
+      Close();
+      return false;
+   }
+
+   m_num_rows = size_t(header->num_rows);
+   const char* data = m_file.GetData() + sizeof(ColumnBinaryHeader);
+   for (int k = 0; k < 4; k++)
+      m_columns[k] = reinterpret_cast<const LtFloat*>(data + k * m_num_rows * sizeof(LtFloat));
+   m_guids = reinterpret_cast<const LtNat8*>(data + 4 * m_num_rows * sizeof(LtFloat));
+
+   return true;
+}
+
+void
+ColumnBinary::Close()
+{
+   m_file.Close();
+   m_num_rows = 0;
+   for (int k = 0; k < 4; k++)
+      m_columns[k] = NULL;
+   m_guids = NULL;
+}
+
+bool
+ColumnBinary::Write(LtWideString pathname, LtWideString source, const ColumnTable& table)
+{
+   size_t num_rows = table.GetSize();
+
+   ColumnBinaryHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, cMAGIC, sizeof(cMAGIC));
+   header.version = cVERSION;
+   header.num_rows = num_rows;
+
+   FileStamp stamp;
+   if (!FileStamp::Get(source, stamp))
+      return false;
+   header.source_size = stamp.size;
+   header.source_write_time = stamp.write_time;
+
+   // Every GUID must have raw data, or loaders would need the text anyway
+   std::vector<LtNat8> guids(num_rows * 16);
+   for (size_t i = 0; i < num_rows; i++)
+   {
+      if (!GuidBatch::ParseGuidString(table.GetGuid(i), &guids[i * 16]))
+         return false;
+   }
+
+   FILE* fp = NULL;
+   _wfopen_s(&fp, pathname, L"wb");
+   if (!fp)
+      return false;
+
+   bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+   std::vector<LtFloat> column(num_rows);
+   for (int k = 0; k < 4 && ok; k++)
+   {
+      for (size_t i = 0; i < num_rows; i++)
+      {
+         if (k == 0)
+         {
+            column[i] = table.GetHeight(i);
+         }
+         else
+         {
+            LtPoint center;
+            table.GetCenter(i, center);
+            column[i] = center[k - 1];
+         }
+      }
+      ok = fwrite(column.data(), sizeof(LtFloat), num_rows, fp) == num_rows;
+   }
+
+   if (ok)
+      ok = fwrite(guids.data(), 16, num_rows, fp) == num_rows;
+
+   if (fclose(fp) != 0)
+      ok = false;
+   if (!ok)
+      _wremove(pathname);
+
+   return ok;
+}
+
+LtNwcLoadStatus
+ColumnBinary::LoadFromFile(LtWideString source, ColumnTable& table)
+{
+   std::shared_ptr<ColumnBinary> binary(new ColumnBinary);
+   if (!binary->Open(GetCompanionPathname(source).c_str(), source))
+      return ColumnTable::LoadFromFile(source, table);
+
+   // The table owns the mapping from here on
+   table.Map(binary->GetSize(), binary->GetHeights(), binary->GetX(), binary->GetY(),
+             binary->GetZ(), binary->GetGuid(0), binary);
+
+   return LI_NWC_LOAD_OK;
+}
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+
+#ifndef COLUMNBINARY_HDR
+#define COLUMNBINARY_HDR
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nwcreate/LiNwcAll.h>
+
+#include "ColumnSpec.h"
+#include "MappedFile.h"
+
+// Binary companion of an .mlf file, written next to it by ColumnPacker with
+// the same name and an .mlb extension. LoadFromFile maps it into a
+// ColumnTable that reads its columns in place, with no parsing or copying.
+//
+// The file is a 64 byte header followed by the height, x, y and z columns
+// as arrays of doubles and then a 16 byte raw GUID per row, laid out as a
+// Windows GUID in memory. The header records the size and write time of the
+// .mlf file it was made from, so a companion is only used while the text
+// file is unchanged.
+class ColumnBinary
+{
+public:
+   ColumnBinary();
+
+   // Pathname of the companion of an .mlf file
+   static std::wstring GetCompanionPathname(LtWideString source);
+
+   // False if pathname isn't a valid companion of source as it is now
+   bool Open(LtWideString pathname, LtWideString source);
+   void Close();
+
+   size_t GetSize() const { return m_num_rows; }
+   const LtFloat* GetHeights() const { return m_columns[0]; }
+   const LtFloat* GetX() const { return m_columns[1]; }
+   const LtFloat* GetY() const { return m_columns[2]; }
+   const LtFloat* GetZ() const { return m_columns[3]; }
+   const LtNat8* GetGuid(size_t i) const { return m_guids + i * 16; }
+
+   // Writes table as the companion of source. False if a GUID isn't in
+   // 8-4-4-4-12 form or the file can't be written.
+   static bool Write(LtWideString pathname, LtWideString source, const ColumnTable& table);
+
+   // Reads the columns of an .mlf file from its companion if it has an up
+   // to date one, otherwise from the text. A table read from the companion
+   // is mapped: it uses the companion's arrays and raw GUIDs in place and
+   // keeps the file mapped until it is cleared or destroyed.
+   static LtNwcLoadStatus LoadFromFile(LtWideString source, ColumnTable& table);
+
+private:
+   // Can't copy
+   ColumnBinary(const ColumnBinary&);
+   ColumnBinary& operator= (const ColumnBinary&);
+
+   MappedFile m_file;
+   size_t m_num_rows;
+   const LtFloat* m_columns[4];
+   const LtNat8* m_guids;
+};
+
+#endif // COLUMNBINARY_HDR
@@ -0,0 +1,44 @@
+//------------------------------------------------------------------
+// NavisWorks Sample code
+//------------------------------------------------------------------
+//
+// (C) Copyright 2021 by Autodesk Inc.
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted,
+// provided that the above copyright notice appears in all copies and
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS.
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//------------------------------------------------------------------
+
+#ifndef COLUMNGEOMETRY_HDR
+#define COLUMNGEOMETRY_HDR
+#pragma once
+
+#include <nwcreate/LiNwcAll.h>
+
+// 3D circle column of unit radius standing on base, as multisheetloader
+// streams it, so converters that share the .mlf format write the same
+// geometry. Stream is an LcNwcGeometryStream or a GeometryRecorder, begun
+// with LI_NWC_VERTEX_NORMAL.
+template <class Stream> void
+stream_circle_column(Stream& stream, const LtPoint base, LtFloat height)
+{
+   LtVector up = { 0, 0, 1 };
+   LtVector down = { 0, 0, -1 };
+   LtPoint bottom = { base[0], base[1], base[2] };
+   LtPoint top = { base[0], base[1], base[2] + height };
+
+   stream.Circle(bottom, down, 1);
+   stream.Cylinder(bottom, top, 1);
+   stream.Circle(top, up, 1);
+}
+
+#endif // COLUMNGEOMETRY_HDR
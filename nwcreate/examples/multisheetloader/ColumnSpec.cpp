@@ -20,39 +20,328 @@
 
 #include "ColumnSpec.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include "MappedFile.h"
+
+// Files smaller than this are parsed on the calling thread
+static const size_t cMIN_PARALLEL_BYTES = 4 * 1024 * 1024;
+
 LtNwcLoadStatus ColumnSpec::LoadFromFile(LtWideString pathname, std::vector<ColumnSpec> &columns)
 {
-   std::wstring height_str;
-   std::wstring x_str;
-   std::wstring y_str;
-   std::wstring z_str;
-   std::wstring guid;
+   ColumnTable table;
+   LtNwcLoadStatus status = ColumnTable::LoadFromFile(pathname, table);
+   if (status != LI_NWC_LOAD_OK)
+      return status;
 
-   std::wifstream file(pathname);
+   columns.reserve(columns.size() + table.GetSize());
+   for (size_t i = 0; i < table.GetSize(); i++)
+   {
+      LtPoint base;
+      table.GetCenter(i, base);
+      columns.push_back(ColumnSpec(table.GetHeight(i), base, table.GetGuid(i)));
+   }
 
-   if (!file.is_open())
-      return LI_NWC_LOAD_CANT_OPEN;
+   return LI_NWC_LOAD_OK;
+}
+
+//
+// ColumnTable
+//
+
+void
+ColumnTable::Clear()
+{
+   m_height.clear();
+   m_x.clear();
+   m_y.clear();
+   m_z.clear();
+   m_guid_chars.clear();
+   m_guid_offsets.clear();
+
+   m_mapping.reset();
+   m_num_mapped = 0;
+   m_mapped_guids = NULL;
+}
+
+void
+ColumnTable::Append(const ColumnTable& other)
+{
+   size_t base = m_guid_chars.size();
+   m_height.insert(m_height.end(), other.m_height.begin(), other.m_height.end());
+   m_x.insert(m_x.end(), other.m_x.begin(), other.m_x.end());
+   m_y.insert(m_y.end(), other.m_y.begin(), other.m_y.end());
+   m_z.insert(m_z.end(), other.m_z.begin(), other.m_z.end());
+   m_guid_chars.insert(m_guid_chars.end(), other.m_guid_chars.begin(), other.m_guid_chars.end());
+   for (size_t i = 0; i < other.m_guid_offsets.size(); i++)
+      m_guid_offsets.push_back(base + other.m_guid_offsets[i]);
+}
+
+void
+ColumnTable::Map(size_t num_rows, const LtFloat* height, const LtFloat* x, const LtFloat* y,
+                 const LtFloat* z, const LtNat8* raw_guids, const std::shared_ptr<const void>& mapping)
+{
+   Clear();
+   m_mapping = mapping;
+   m_num_mapped = num_rows;
+   m_mapped[0] = height;
+   m_mapped[1] = x;
+   m_mapped[2] = y;
+   m_mapped[3] = z;
+   m_mapped_guids = raw_guids;
+}
 
-   while(file.good())
+// Next line end at or after p, or end
+static const char*
+find_line_end(const char* p, const char* end)
+{
+   // memchr is vectorised by the runtime library
+   const void* found = memchr(p, '\n', end - p);
+   return found ? static_cast<const char*>(found) : end;
+}
+
+static const LtNat16*
+find_line_end(const LtNat16* p, const LtNat16* end)
+{
+   while (p < end && *p != '\n')
+      p++;
+   return p;
+}
+
+template <class C>
+static bool
+is_space(C c)
+{
+   return c == ' ' || c == '\t' || c == '\r';
+}
+
+template <class C>
+static bool
+is_digit(C c)
+{
+   return c >= '0' && c <= '9';
+}
+
+// Parses a number from the start of [p, end) with the same result as
+// wcstod. Plain decimals with up to 15 significant digits and small
+// exponents are exact in double arithmetic; anything else goes to wcstod.
+template <class C>
+static LtFloat
+parse_float(const C* p, const C* end)
+{
+   static const LtFloat powers[] =
    {
-      std::getline(file, height_str, L',');
-      std::getline(file, x_str, L',');
-      std::getline(file, y_str, L',');
-      std::getline(file, z_str, L',');
-      std::getline(file, guid);
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+   };
 
-      LtFloat height = wcstod(height_str.c_str(), NULL);
+   const C* start = p;
+   while (p < end && is_space(*p))
+      p++;
 
-      LtPoint base = {
-         wcstod(x_str.c_str(), NULL),
-         wcstod(y_str.c_str(), NULL),
-         wcstod(z_str.c_str(), NULL) };
+   bool negative = false;
+   if (p < end && (*p == '-' || *p == '+'))
+      negative = (*p++ == '-');
+
+   LtNat64 mantissa = 0;
+   int num_digits = 0;
+   int exponent = 0;
+   bool any_digits = false;
+
+   while (p < end && is_digit(*p))
+   {
+      if (mantissa || *p != '0')
+      {
+         mantissa = mantissa * 10 + (*p - '0');
+         num_digits++;
+      }
+      any_digits = true;
+      p++;
+   }
+   if (p < end && *p == '.')
+   {
+      p++;
+      while (p < end && is_digit(*p))
+      {
+         if (mantissa || *p != '0')
+         {
+            mantissa = mantissa * 10 + (*p - '0');
+            num_digits++;
+         }
+         exponent--;
+         any_digits = true;
+         p++;
+      }
+   }
+
+   if (any_digits && p < end && (*p == 'e' || *p == 'E'))
+   {
+      const C* q = p + 1;
+      bool negative_exponent = false;
+      if (q < end && (*q == '-' || *q == '+'))
+         negative_exponent = (*q++ == '-');
 
-      ColumnSpec col = ColumnSpec(height, base, guid);
-      columns.push_back(col);
+      // Without digits the 'e' isn't part of the number
+      if (q < end && is_digit(*q))
+      {
+         int e = 0;
+         while (q < end && is_digit(*q) && e < 10000)
+            e = e * 10 + (*q++ - '0');
+         exponent += negative_exponent ? -e : e;
+      }
    }
 
-   file.close();
+   // Hex needs wcstod
+   bool hex = (p < end && (*p == 'x' || *p == 'X'));
+
+   if (any_digits && !hex && num_digits <= 15 && exponent >= -22 && exponent <= 22)
+   {
+      LtFloat value = LtFloat(mantissa);
+      value = (exponent < 0) ? value / powers[-exponent] : value * powers[exponent];
+      return negative ? -value : value;
+   }
+
+   if (start == end)
+      return 0;
+
+   // Rare forms (long mantissas, big exponents, inf, nan)
+   wchar_t buffer[128];
+   size_t length = 0;
+   for (const C* q = start; q < end && length + 1 < 128; q++)
+      buffer[length++] = wchar_t(*q);
+   buffer[length] = 0;
+   return wcstod(buffer, NULL);
+}
+
+template <class C>
+void
+ColumnTable::ParseLines(const C* p, const C* end)
+{
+   // Counting lines is cheap next to parsing them and saves regrowing
+   size_t num_lines = 0;
+   for (const C* q = p; q < end; q = find_line_end(q, end) + 1)
+      num_lines++;
+
+   size_t size = GetSize() + num_lines;
+   m_height.reserve(size);
+   m_x.reserve(size);
+   m_y.reserve(size);
+   m_z.reserve(size);
+   m_guid_offsets.reserve(size);
+   m_guid_chars.reserve(m_guid_chars.size() + num_lines * 37);
+
+   while (p < end)
+   {
+      const C* line_end = find_line_end(p, end);
+
+      // Skip blank lines
+      const C* q = p;
+      while (q < line_end && is_space(*q))
+         q++;
+      if (q == line_end)
+      {
+         p = line_end + 1;
+         continue;
+      }
+
+      // Four numbers, then the GUID up to the line end
+      LtFloat values[4] = { 0, 0, 0, 0 };
+      for (int i = 0; i < 4 && p < line_end; i++)
+      {
+         const C* comma = p;
+         while (comma < line_end && *comma != ',')
+            comma++;
+         values[i] = parse_float(p, comma);
+         p = (comma < line_end) ? comma + 1 : line_end;
+      }
+
+      const C* guid_end = line_end;
+      while (guid_end > p && is_space(guid_end[-1]))
+         guid_end--;
+
+      m_height.push_back(values[0]);
+      m_x.push_back(values[1]);
+      m_y.push_back(values[2]);
+      m_z.push_back(values[3]);
+      m_guid_offsets.push_back(m_guid_chars.size());
+      m_guid_chars.insert(m_guid_chars.end(), p, guid_end);
+      m_guid_chars.push_back(0);
+
+      p = line_end + 1;
+   }
+}
+
+// Splits [begin, end) into up to num_chunks ranges that start at line starts
+// and parses them on separate threads.
+template <class C>
+static void
+parse_chunks(const C* begin, const C* end, LtInt32 num_chunks, ColumnTable& table,
+             void (ColumnTable::*parse)(const C*, const C*))
+{
+   std::vector<const C*> starts(1, begin);
+   for (LtInt32 i = 1; i < num_chunks; i++)
+   {
+      const C* split = begin + (end - begin) * i / num_chunks;
+      if (split < starts.back())
+         continue;
+      split = find_line_end(split, end);
+      if (split < end)
+         starts.push_back(split + 1);
+   }
+   starts.push_back(end);
+
+   std::vector<ColumnTable> parts(starts.size() - 1);
+   std::vector<std::thread> workers;
+   for (size_t i = 0; i < parts.size(); i++)
+      workers.push_back(std::thread(parse, &parts[i], starts[i], starts[i + 1]));
+   for (size_t i = 0; i < workers.size(); i++)
+      workers[i].join();
+
+   for (size_t i = 0; i < parts.size(); i++)
+      table.Append(parts[i]);
+}
+
+LtNwcLoadStatus
+ColumnTable::LoadFromFile(LtWideString pathname, ColumnTable& table, LtInt32 num_threads)
+{
+   MappedFile file;
+   if (!file.Open(pathname))
+      return LI_NWC_LOAD_CANT_OPEN;
+
+   const char* data = file.GetData();
+   size_t size = file.GetSize();
+
+   if (num_threads <= 0)
+      num_threads = LtInt32(std::thread::hardware_concurrency());
+   if (num_threads <= 0 || size < cMIN_PARALLEL_BYTES)
+      num_threads = 1;
+
+   if (size >= 2 && LtNat8(data[0]) == 0xff && LtNat8(data[1]) == 0xfe)
+   {
+      // UTF-16 little endian
+      const LtNat16* begin = reinterpret_cast<const LtNat16*>(data + 2);
+      const LtNat16* end = begin + (size - 2) / 2;
+      if (num_threads == 1)
+         table.ParseLines(begin, end);
+      else
+         parse_chunks(begin, end, num_threads, table, &ColumnTable::ParseLines<LtNat16>);
+   }
+   else
+   {
+      // UTF-8 byte order mark
+      if (size >= 3 && LtNat8(data[0]) == 0xef && LtNat8(data[1]) == 0xbb && LtNat8(data[2]) == 0xbf)
+      {
+         data += 3;
+         size -= 3;
+      }
+
+      if (num_threads == 1)
+         table.ParseLines(data, data + size);
+      else
+         parse_chunks(data, data + size, num_threads, table, &ColumnTable::ParseLines<char>);
+   }
 
    return LI_NWC_LOAD_OK;
-}
\ No newline at end of file
+}
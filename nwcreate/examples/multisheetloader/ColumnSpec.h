@@ -22,6 +22,7 @@
 #define COLUMN_HDR
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <fstream>
 #include <sstream>
@@ -47,16 +48,16 @@ public:
       m_guid = guid;
    }
 
-   LtFloat GetHeight() 
+   LtFloat GetHeight() const
    {
       return m_height;
    }
-   void GetCenter(LtPoint &ret)
+   void GetCenter(LtPoint &ret) const
    {
       for (int i = 0; i < 3; i++)
          ret[i] = m_base[i];
    }
-   std::wstring GetGuid() 
+   const std::wstring& GetGuid() const
    {
       return m_guid;
    }
@@ -69,4 +70,92 @@ private:
    std::wstring m_guid;
 };
 
+// Columns of an .mlf file held as one array per field, for files too big
+// to hold as a ColumnSpec per row. The arrays are either parsed from the
+// text or, for a binary companion, used in place from its mapping.
+class ColumnTable
+{
+public:
+   ColumnTable() : m_num_mapped(0), m_mapped_guids(NULL)
+   {
+      for (int k = 0; k < 4; k++)
+         m_mapped[k] = NULL;
+   }
+
+   size_t GetSize() const { return m_mapping ? m_num_mapped : m_height.size(); }
+   LtFloat GetHeight(size_t i) const { return m_mapping ? m_mapped[0][i] : m_height[i]; }
+   void GetCenter(size_t i, LtPoint& ret) const
+   {
+      if (m_mapping)
+      {
+         ret[0] = m_mapped[1][i];
+         ret[1] = m_mapped[2][i];
+         ret[2] = m_mapped[3][i];
+      }
+      else
+      {
+         ret[0] = m_x[i];
+         ret[1] = m_y[i];
+         ret[2] = m_z[i];
+      }
+   }
+   // NULL for a mapped table, which has raw GUIDs
+   LtWideString GetGuid(size_t i) const
+   {
+      return m_mapping ? NULL : &m_guid_chars[m_guid_offsets[i]];
+   }
+   // NULL for a table parsed from text, 16 bytes laid out as a Windows GUID
+   const LtNat8* GetRawGuid(size_t i) const
+   {
+      return m_mapping ? m_mapped_guids + i * 16 : NULL;
+   }
+
+   void Clear();
+
+   // Appends the rows of a parsed table to a parsed table
+   void Append(const ColumnTable& other);
+
+   // Uses num_rows rows of arrays owned by mapping in place of the table's
+   // own. The table holds mapping, keeping the arrays valid, until Clear.
+   void Map(size_t num_rows, const LtFloat* height, const LtFloat* x, const LtFloat* y,
+            const LtFloat* z, const LtNat8* raw_guids, const std::shared_ptr<const void>& mapping);
+
+   // Reads a file of height,x,y,z,guid lines, 8 bit (or UTF-8) or UTF-16
+   // with a byte order mark. The file is mapped rather than streamed and
+   // large files are parsed in chunks, split at line ends, on num_threads
+   // threads (zero for one per processor). Blank lines are skipped.
+   static LtNwcLoadStatus LoadFromFile(LtWideString pathname, ColumnTable& table,
+                                       LtInt32 num_threads = 0);
+
+private:
+   template <class C>
+   void ParseLines(const C* begin, const C* end);
+
+   std::vector<LtFloat> m_height;
+   std::vector<LtFloat> m_x;
+   std::vector<LtFloat> m_y;
+   std::vector<LtFloat> m_z;
+   std::vector<wchar_t> m_guid_chars;  // Null terminated
+   std::vector<size_t> m_guid_offsets;
+
+   std::shared_ptr<const void> m_mapping;
+   size_t m_num_mapped;
+   const LtFloat* m_mapped[4];         // Height, x, y, z
+   const LtNat8* m_mapped_guids;
+};
+
+// One row of a ColumnTable, read like a ColumnSpec
+class ColumnRow
+{
+public:
+   ColumnRow(const ColumnTable& table, size_t i) : m_table(&table), m_index(i) {}
+
+   LtFloat GetHeight() const { return m_table->GetHeight(m_index); }
+   void GetCenter(LtPoint& ret) const { m_table->GetCenter(m_index, ret); }
+
+private:
+   const ColumnTable* m_table;
+   size_t m_index;
+};
+
 #endif // COLUMN_HDR
@@ -22,10 +22,55 @@
 #include <stdlib.h>
 
 #include <nwcreate/LiNwcAll.h>
+#include "BRepFaceCounter.h"
+#include "BRepTemplateCache.h"
+#include "ColumnBinary.h"
+#include "ColumnGeometry.h"
 #include "ColumnSpec.h"
+#include "CurveFlattener.h"
+#include "DatasetCache.h"
+#include "FileSniffer.h"
+#include "GeometryInstancer.h"
+#include "GeometryPipeline.h"
+#include "GridBuilder.h"
+#include "GuidBatch.h"
+#include "PlotPathBatcher.h"
+#include "PlotTiler.h"
+#include "PolylineSimplifier.h"
+#include "PropertyTable.h"
+#include "TessellationCache.h"
 
 // Loader parameters. Should match defaults in define_options_cb.
 ColumnProfile ColumnSpec::m_profile = eCIRCLE;
+static bool f_cache_tessellation = false;
+static bool f_recenter_geometry = false;
+static bool f_reuse_brep_profiles = false;
+
+// I profile prisms built once per height and copied to each column.
+// Cleared however each load ends, so no BRep entities outlive it.
+static BRepTemplateCache f_brep_templates;
+
+struct ClearBRepTemplates
+{
+   ~ClearBRepTemplates() { f_brep_templates.Clear(); }
+};
+
+// Drops plot points closer than plot_tolerance to the simplified outline.
+// Past about 0.35 the I profile starts losing the corners of its notches.
+static PolylineSimplifier f_plot_simplifier;
+
+// Flattens 2D circles to curve_tolerance, if set, rather than streaming
+// circle segments. Flattened circles are kept between loads.
+static bool f_flatten_curves = false;
+static CurveFlattener f_curve_flattener;
+static std::vector<LtFloat> f_curve_points;
+
+// Columns read from each file, or its binary companion, shared by its 2D
+// and 3D sheets.
+static DatasetCache<ColumnTable> f_datasets(&ColumnBinary::LoadFromFile);
+
+// Facets shared by circle columns of the same size, kept between loads.
+static TessellationCache f_tessellation_cache;
 
 // Useful base vectors.
 LtPoint origin = {0, 0, 0};
@@ -34,28 +79,36 @@ LtVector y = { 0, 1, 0 };
 LtVector z = { 0, 0, 1 };
 LtVector mz = { 0, 0, -1 };
 
-// Define geometry for 3D column with circle profile.
-static LtBoolean LI_NWC_API
-geom_col_circle(LcNwcGeometryStream stream, 
-                ColumnSpec* spec)
+// Define geometry for 3D column with circle profile. Stream is either an
+// LcNwcGeometryStream or a GeometryRecorder.
+template <class Stream> static LtBoolean
+geom_col_circle(Stream& stream, 
+                const ColumnRow* spec)
 {
    LtPoint base;
    spec->GetCenter(base);
 
-   LtPoint top = {base[0], base[1], base[2] + spec->GetHeight()};
-   LtFloat r = 1;
+   if (f_cache_tessellation)
+   {
+      LtPoint top = {base[0], base[1], base[2] + spec->GetHeight()};
+      LtFloat r = 1;
 
-   stream.Circle(base, mz, r);
-   stream.Cylinder(base, top, r);
-   stream.Circle(top, z, r);
+      f_tessellation_cache.Circle(stream, base, mz, r);
+      f_tessellation_cache.Cylinder(stream, base, top, r);
+      f_tessellation_cache.Circle(stream, top, z, r);
+   }
+   else
+   {
+      stream_circle_column(stream, base, spec->GetHeight());
+   }
 
    return TRUE;
 }
 
 // Define geometry for 3D column with square profile.
-static LtBoolean LI_NWC_API
-geom_col_square(LcNwcGeometryStream stream, 
-                ColumnSpec* spec)
+template <class Stream> static LtBoolean
+geom_col_square(Stream& stream, 
+                const ColumnRow* spec)
 {
    LtPoint base;
    spec->GetCenter(base);
@@ -68,51 +121,76 @@ geom_col_square(LcNwcGeometryStream stream,
    return TRUE;
 }
 
-// Define geometry for 3D column with I profile.
-static LtBoolean LI_NWC_API
-geom_col_I(LcNwcGeometryStream stream, 
-           ColumnSpec* spec)
+// I profile prism of height params[2], centered on params[0], params[1] and
+// standing on the xy plane.
+static LcNwcBRepEntity
+build_col_I(const LtFloat* params, void* user_data)
 {
-   LtPoint base;
-   spec->GetCenter(base);
+   LtFloat cx = params[0], cy = params[1];
 
    LcNwcPlane plane(origin, x, y);
    LcNwcBRepProfileBuilder builder(plane);
 
    builder.SetRadius(0.0);
-   builder.AddPoint(base[0] + 1,   base[1] + 1);
-   builder.AddPoint(base[0] + 1,   base[1] + 0.5);
-   builder.AddPoint(base[0] + 0.5, base[1] + 0.5);
-   builder.AddPoint(base[0] + 0.5, base[1] - 0.5);
-   builder.AddPoint(base[0] + 1,   base[1] - 0.5);
-   builder.AddPoint(base[0] + 1,   base[1] - 1);
-   builder.AddPoint(base[0] - 1,   base[1] - 1);
-   builder.AddPoint(base[0] - 1,   base[1] - 0.5);
-   builder.AddPoint(base[0] - 0.5, base[1] - 0.5);
-   builder.AddPoint(base[0] - 0.5, base[1] + 0.5);
-   builder.AddPoint(base[0] - 1,   base[1] + 0.5);
-   builder.AddPoint(base[0] - 1,   base[1] + 1);
+   builder.AddPoint(cx + 1,   cy + 1);
+   builder.AddPoint(cx + 1,   cy + 0.5);
+   builder.AddPoint(cx + 0.5, cy + 0.5);
+   builder.AddPoint(cx + 0.5, cy - 0.5);
+   builder.AddPoint(cx + 1,   cy - 0.5);
+   builder.AddPoint(cx + 1,   cy - 1);
+   builder.AddPoint(cx - 1,   cy - 1);
+   builder.AddPoint(cx - 1,   cy - 0.5);
+   builder.AddPoint(cx - 0.5, cy - 0.5);
+   builder.AddPoint(cx - 0.5, cy + 0.5);
+   builder.AddPoint(cx - 1,   cy + 0.5);
+   builder.AddPoint(cx - 1,   cy + 1);
    
    LcNwcLoop loop = builder.CreateLoop();
    LcNwcFace face(plane, LI_NWC_SENSE_POSITIVE);
    face.AddLoop(loop);
 
-   LcNwcBRepPrism column(face, z, spec->GetHeight(), true);
-   stream.BRepEntity(column);
-   
-   return TRUE;
+   return LcNwcBRepPrism(face, z, params[2], true);
+}
+
+// Solid for 3D column with I profile.
+static LcNwcBRepEntity
+create_col_I(const ColumnRow* spec)
+{
+   LtPoint base;
+   spec->GetCenter(base);
+
+   if (f_reuse_brep_profiles)
+   {
+      // Copy of the prism for this height built at the origin, moved to
+      // the column.
+      LtFloat params[3] = { 0, 0, spec->GetHeight() };
+      LtVector offset = { base[0], base[1], 0 };
+      return f_brep_templates.CreateTranslated(&build_col_I, params, 3, offset);
+   }
+
+   LtFloat params[3] = { base[0], base[1], spec->GetHeight() };
+   return build_col_I(params, NULL);
 }
 
 // Define geometry for 2D column with circle profile.
 static LtBoolean LI_NWC_API
 geom_col_circle(LcNwcPlotGeometryStream path_geo_stream, 
-                ColumnSpec* spec)
+                const ColumnRow* spec)
 {
    LtPoint base;
    spec->GetCenter(base);
 
-   LcNwcPlotCircleSegment circle = LcNwcPlotCircleSegment(path_geo_stream);
    LtPoint2d center = {base[0], base[1]};
+
+   if (f_flatten_curves)
+   {
+      f_curve_points.clear();
+      f_curve_flattener.Circle(center, 1.0, f_curve_points);
+      CurveFlattener::PolyLineSegment(path_geo_stream, true, f_curve_points);
+      return TRUE;
+   }
+
+   LcNwcPlotCircleSegment circle = LcNwcPlotCircleSegment(path_geo_stream);
    circle.SetCenterPoint(center);
    circle.SetRadius(1.0);
 
@@ -124,7 +202,7 @@ geom_col_circle(LcNwcPlotGeometryStream path_geo_stream,
 // Define geometry for 2D column with square profile.
 static LtBoolean LI_NWC_API
 geom_col_square(LcNwcPlotGeometryStream path_geo_stream, 
-                ColumnSpec* spec)
+                const ColumnRow* spec)
 {
    LtPoint base;
    spec->GetCenter(base);
@@ -137,11 +215,8 @@ geom_col_square(LcNwcPlotGeometryStream path_geo_stream,
       {base[0] - 1,   base[1] + 1}, 
       {base[0] + 1,   base[1] + 1} };
 
-   // Begin a polyline segement.
-   path_geo_stream.PolyLineSegmentBegin(true);
-   for (LtInt32 i = 0; i < 5; ++i)
-      path_geo_stream.PolyLineSegmentPoint(points[i]);
-   path_geo_stream.PolyLineSegmentEnd();
+   // Stream a polyline segment, simplified.
+   f_plot_simplifier.PolyLineSegment(path_geo_stream, true, points, 5);
 
    return TRUE;
 }
@@ -149,7 +224,7 @@ geom_col_square(LcNwcPlotGeometryStream path_geo_stream,
 // Define geometry for 2D column with I profile.
 static LtBoolean LI_NWC_API
 geom_col_I(LcNwcPlotGeometryStream path_geo_stream, 
-           ColumnSpec* spec)
+           const ColumnRow* spec)
 {
    LtPoint base;
    spec->GetCenter(base);
@@ -170,15 +245,24 @@ geom_col_I(LcNwcPlotGeometryStream path_geo_stream,
       {base[0] - 1,   base[1] + 1}, 
       {base[0] + 1,   base[1] + 1} };
 
-   // Begin a polyline segement.
-   path_geo_stream.PolyLineSegmentBegin(true);
-   for (LtInt32 i = 0; i < 13; ++i)
-      path_geo_stream.PolyLineSegmentPoint(points[i]);
-   path_geo_stream.PolyLineSegmentEnd();
+   // Stream a polyline segment, simplified.
+   f_plot_simplifier.PolyLineSegment(path_geo_stream, true, points, 13);
 
    return TRUE;
 }
 
+// Columns drawn into one plot stream.
+struct ColumnPlot
+{
+   const ColumnTable* columns;
+   const LtInt32* items;         // indices into columns, NULL for in order
+   LtInt32 num_columns;
+   PlotPathBatcher* paths;
+   LtInt32 style;
+   const PlotTiler* tiler;       // wraps the tile in a canvas, if set
+   LtInt32 tile;
+};
+
 // 2D geometry.
 static LtBoolean LI_NWC_API
 geometry(LtNwcGeometry geometry, 
@@ -186,123 +270,140 @@ geometry(LtNwcGeometry geometry,
          void* user_data)
 {
    LcNwcPlotStream stream(stream_handle);
-   ColumnSpec* spec = static_cast<ColumnSpec*>(user_data);
-
-   // Prepare path style: fill brush and stroke to draw a figure
-   // 
-   // fill brush, red one
-   LcNwcPlotSolidColorBrush brush;
-   brush.SetColor(1, 0, 0, 1);
-   // stroke, set its color by brush
-   LcNwcPlotStroke stroke;
-   stroke.SetBrush(brush);
-
-   // Then set the defined filled brush and stroke to path style
-   LcNwcPlotPathStyle path_style;
-   path_style.SetFill(brush);
-   path_style.SetStroke(stroke);
-
-   // Begin path, mandatory if you want to draw figures
-   stream.PathBegin(path_style);
-
-   // Begin the path geometry stream in this path
-   LcNwcPlotPathStreamStyle path_stream_style;
-   path_stream_style.SetFillRule(LI_NWC_PLOT_PATH_FILL_RULE_NONE);
-   LcNwcPlotGeometryStream path_geo_stream = stream.PathStreamOpen(path_stream_style);
-
-   // Begin the path figure
-   LcNwcPlotPathFigureStyle path_figure_style;
-   path_geo_stream.PathFigureBegin(path_figure_style);
-
-   // Define the path figure.
-   if (spec->m_profile == eSQUARE)
-      geom_col_square(path_geo_stream, spec);
-   else if (spec->m_profile == eIBEAM)
-      geom_col_I(path_geo_stream, spec);
-   else
-      geom_col_circle(path_geo_stream, spec);
+   const ColumnPlot* plot = static_cast<const ColumnPlot*>(user_data);
 
-   // End the path figure
-   path_geo_stream.PathFigureEnd();
-   stream.PathStreamClose(path_geo_stream);
+   if (plot->tiler)
+      plot->tiler->CanvasBegin(stream, plot->tile);
 
-   // End path
-   stream.PathEnd();
+   for (LtInt32 i = 0; i < plot->num_columns; i++)
+   {
+      ColumnRow spec(*plot->columns, plot->items ? plot->items[i] : i);
 
-   return TRUE;
-}
+      // Begin the path figure. Figures with the same path style (fill brush
+      // and stroke) go into one path, begun by the first of them.
+      LcNwcPlotGeometryStream path_geo_stream = plot->paths->FigureBegin(stream, plot->style);
 
-// 3D geometry.
-static LtBoolean LI_NWC_API
-geometry(LtNwcGeometry geometry, 
-         LtNwcGeometryStream stream_handle, 
-         void* user_data)
-{
-   LcNwcGeometryStream stream(stream_handle);
-   ColumnSpec* spec = static_cast<ColumnSpec*>(user_data);
+      // Define the path figure.
+      if (ColumnSpec::m_profile == eSQUARE)
+         geom_col_square(path_geo_stream, &spec);
+      else if (ColumnSpec::m_profile == eIBEAM)
+         geom_col_I(path_geo_stream, &spec);
+      else
+         geom_col_circle(path_geo_stream, &spec);
 
-   stream.Begin(LI_NWC_VERTEX_NORMAL);
+      // End the path figure
+      plot->paths->FigureEnd();
+   }
 
-   if (spec->m_profile == eSQUARE)
-      geom_col_square(stream, spec);
-   else if (spec->m_profile == eIBEAM)
-      geom_col_I(stream, spec);
-   else
-      geom_col_circle(stream, spec);
+   // End path
+   plot->paths->Flush();
 
-   stream.End();
+   if (plot->tiler)
+      plot->tiler->CanvasEnd(stream);
 
    return TRUE;
 }
 
-static LtBoolean LI_NWC_API
-add_grid_level(LcNwcGridSystem system, 
-               LtFloat height, 
-               LtWideString label)
+// Record 3D geometry for instancing. I profile columns are BRep entities,
+// which aren't recorded.
+static void
+record_geometry(GeometryRecorder& recorder, 
+                const ColumnRow* spec)
 {
-   LcNwcGridLevel level(label, height);
-   system.AddGridLevel(level);
+   recorder.Begin(LI_NWC_VERTEX_NORMAL);
 
-   return TRUE;
+   if (ColumnSpec::m_profile == eSQUARE)
+      geom_col_square(recorder, spec);
+   else
+      geom_col_circle(recorder, spec);
+
+   recorder.End();
 }
 
-static LtBoolean LI_NWC_API
-add_grid_line(LcNwcGridSystem system, 
-              LtWideString label, 
-              LtPoint start, 
-              LtPoint end)
+// Shared by the pipeline callbacks while building the 3D sheet.
+struct ColumnBuild
 {
-   LcNwcGridLine line(label);
-   line.AddLinearSegment(start, end);
-   system.AddGridLine(line);
-
-   return TRUE;
+   const ColumnTable* columns;
+   GeometryInstancer* instancer;       // NULL if not instancing
+   LcNwcProgress* progress;
+   std::vector<LtInt32> instances;     // Instance per column, if instancing
+   std::vector<LcNwcNode> nodes;       // Node per column, if not
+};
+
+// Runs on a worker thread, no NWcreate calls allowed.
+static void
+build_column_cb(LtInt32 item, 
+                GeometryRecorder& recorder, 
+                void* user_data)
+{
+   ColumnBuild* build = static_cast<ColumnBuild*>(user_data);
+   ColumnRow spec(*build->columns, item);
+   record_geometry(recorder, &spec);
 }
 
-static LtBoolean LI_NWC_API
-add_grid_lines(LcNwcGridSystem system)
+// Runs on the loader thread in column order.
+static bool
+submit_column_cb(LtInt32 item, 
+                 const GeometryRecorder& recorder, 
+                 void* user_data)
 {
-   LtPoint lineA[2] = { {-10, -5, 0}, {10, -5, 0} };
-   add_grid_line(system, L"A", lineA[0], lineA[1]);
+   ColumnBuild* build = static_cast<ColumnBuild*>(user_data);
 
-   LtPoint lineB[2] = { {-10, 0, 0}, {10, 0, 0} };
-   add_grid_line(system, L"B", lineB[0], lineB[1]);
+   if (build->instancer)
+   {
+      build->instances.push_back(build->instancer->Add(recorder));
+   }
+   else
+   {
+      LcNwcGeometry geom;
+      LcNwcGeometryStream geom_stream = geom.OpenStream();
+      if (f_recenter_geometry)
+         recorder.ReplayRecentered(geom_stream);
+      else
+         recorder.Replay(geom_stream);
+      geom.CloseStream(geom_stream);
+      build->nodes.push_back(geom);
+   }
 
-   LtPoint lineC[2] = { {-10, 5, 0}, {10, 5, 0} };
-   add_grid_line(system, L"C", lineC[0], lineC[1]);
+   return build->progress->Update(LtFloat(item + 1) / build->columns->GetSize());
+}
 
-   LtPoint line1[2] = { {-5, -10, 0}, {-5, 10, 0} };
-   add_grid_line(system, L"1", line1[0], line1[1]);
+// Example structural grid, lettered across and numbered along.
+static void
+add_grid_lines(GridBuilder& grid)
+{
+   static const LtWideString labels[] = { L"A", L"B", L"C", L"1", L"2", L"3" };
+   static const LtPoint starts[] = { {-10, -5, 0}, {-10, 0, 0}, {-10, 5, 0},
+                                     {-5, -10, 0}, {0, -10, 0}, {5, -10, 0} };
+   static const LtPoint ends[] = { {10, -5, 0}, {10, 0, 0}, {10, 5, 0},
+                                   {-5, 10, 0}, {0, 10, 0}, {5, 10, 0} };
 
-   LtPoint line2[2] = { {0, -10, 0}, {0, 10, 0} };
-   add_grid_line(system, L"2", line2[0], line2[1]);
+   grid.AddLines(6, labels, starts, ends);
+}
 
-   LtPoint line3[2] = { {5, -10, 0}, {5, 10, 0} };
-   add_grid_line(system, L"3", line3[0], line3[1]);
- 
-   return TRUE;
+// First line is height,x,y,z,guid. Any GUID string is accepted, as the
+// loader does. An empty file is a file with no columns.
+static bool
+sniff_mlf(const char* data, size_t size, bool truncated)
+{
+   std::string text = FileSniffer::GetText(data, size, truncated);
+   size_t pos = 0;
+   std::string line;
+   if (!FileSniffer::GetLine(text, pos, 0, line))
+      return !truncated;
+
+   if (FileSniffer::CountNumbers(line, ',') < 4)
+      return false;
+
+   size_t comma = line.find(',');
+   for (int i = 0; i < 3 && comma != std::string::npos; i++)
+      comma = line.find(',', comma + 1);
+   return comma != std::string::npos &&
+          line.find_first_not_of(" \t", comma + 1) != std::string::npos;
 }
 
+static FileSniffer f_sniffer(&sniff_mlf);
+
 static void LI_NWC_API
 define_options_cb(LtNwcLoader loader, 
                   LtNwcOptionSet option_set, 
@@ -313,6 +414,36 @@ define_options_cb(LtNwcLoader loader,
 
    value.SetNameEnum(NULL, "navisworks_mlf_column_profile", eCIRCLE);
    opts.DefineOption("column_profile", value);
+
+   value.SetBoolean(false);
+   opts.DefineOption("instance_geometry", value);
+
+   value.SetBoolean(false);
+   opts.DefineOption("cache_tessellation", value);
+
+   value.SetBoolean(false);
+   opts.DefineOption("recenter_geometry", value);
+
+   value.SetBoolean(false);
+   opts.DefineOption("name_columns", value);
+
+   value.SetBoolean(false);
+   opts.DefineOption("column_properties", value);
+
+   value.SetBoolean(false);
+   opts.DefineOption("reuse_brep_profiles", value);
+
+   value.SetFloat(0);
+   opts.DefineOption("plot_tolerance", value);
+
+   value.SetBoolean(false);
+   opts.DefineOption("batch_2d_figures", value);
+
+   value.SetInt32(0);
+   opts.DefineOption("tile_2d_figures", value);
+
+   value.SetFloat(0);
+   opts.DefineOption("curve_tolerance", value);
 }
 
 static LtNwcLoadStatus LI_NWC_API 
@@ -341,6 +472,9 @@ load_fileinfo_cb(LtNwcLoader loader_handle,
    // Set the default sheet.
    fileinfo.SetCurrentSheetId(L"sheet2D");
 
+   // Start parsing while the sheet list is shown, whichever sheet is loaded.
+   f_datasets.Prefetch(pathname);
+
    return LI_NWC_LOAD_OK;
 }
 
@@ -364,58 +498,271 @@ load_file_sheet_cb(LtNwcLoader loader_handle,
 
    ColumnSpec::m_profile = static_cast<ColumnProfile>(profile_type);
 
-   // Load file.
-   std::vector<ColumnSpec> columns;
-   LtNwcLoadStatus status = ColumnSpec::LoadFromFile(pathname, columns);
+   options.GetOption("instance_geometry", value);
+   bool use_instancing = value.GetBoolean();
+
+   options.GetOption("cache_tessellation", value);
+   f_cache_tessellation = value.GetBoolean();
+   f_tessellation_cache.ClearStatistics();
+
+   options.GetOption("recenter_geometry", value);
+   f_recenter_geometry = value.GetBoolean();
+
+   options.GetOption("name_columns", value);
+   bool name_columns = value.GetBoolean();
+
+   options.GetOption("column_properties", value);
+   bool column_properties = value.GetBoolean();
+
+   options.GetOption("reuse_brep_profiles", value);
+   f_reuse_brep_profiles = value.GetBoolean();
+
+   options.GetOption("plot_tolerance", value);
+   f_plot_simplifier.SetTolerance(value.GetFloat());
+   f_plot_simplifier.ClearStatistics();
+
+   options.GetOption("batch_2d_figures", value);
+   bool batch_2d = value.GetBoolean();
+
+   // Tiling batches outlines within each tile.
+   options.GetOption("tile_2d_figures", value);
+   LtInt32 tile_size = value.GetInt32();
+   batch_2d = (batch_2d || tile_size > 0) && !wcscmp(sheet_id, L"sheet2D");
+
+   options.GetOption("curve_tolerance", value);
+   f_flatten_curves = value.GetFloat() > 0;
+   if (f_flatten_curves)
+      f_curve_flattener.SetTolerance(value.GetFloat());
+   f_curve_flattener.ClearStatistics();
+
+   // Load file, or reuse columns already parsed for another sheet.
+   LtNwcLoadStatus status;
+   std::shared_ptr<const ColumnTable> dataset = f_datasets.Get(pathname, status);
 
    if (status != LI_NWC_LOAD_OK)
       return status;
 
+   const ColumnTable& columns = *dataset;
+   ClearBRepTemplates clear_brep_templates;
+
    LcNwcScene scene(scene_handle);
-   scene.SetStatistics(pathname);
 
-   // Begin building grid.
-   LcNwcGridSystem system(L"MLFGridSystem", origin, x, y);
-   add_grid_lines(system);
+   // Begin building grid. Column tops are collected and merged into one
+   // level per elevation at the end.
+   GridBuilder grid;
+   add_grid_lines(grid);
+
+   int num_cols = (int) columns.GetSize();
+
+   // 3D circle and square columns are recorded on worker threads and
+   // submitted in column order. Repeated columns share geometry if instancing.
+   GeometryInstancer instancer;
+   instancer.SetRecenter(f_recenter_geometry);
+   LcNwcProgress progress(progress_handle);
+   bool record_3d = !wcscmp(sheet_id, L"sheet3D") && ColumnSpec::m_profile != eIBEAM;
+   bool instance_geometry = use_instancing && record_3d;
+
+   // 3D I profile columns are BRep solids, faceted by NWcreate as they
+   // are streamed, so on this thread.
+   bool facet_3d = !wcscmp(sheet_id, L"sheet3D") && ColumnSpec::m_profile == eIBEAM;
+   BRepFaceCounter brep_faces;
+
+   // Column properties as one table, when asked for. Columns with the same
+   // height and elevation share a property attribute.
+   static const wchar_t* profile_names[] = { L"Circle", L"Square", L"I" };
+   PropertyTable properties;
+   properties.SetClassName(L"Column", "navisworks_mlf_column_properties");
+   properties.AddConcept(L"Column");
+   LtInt32 height_field = properties.AddDoubleField("height", LI_NWC_SCHEMA_UNIT_GROUP_LENGTH);
+   LtInt32 elevation_field = properties.AddDoubleField("base_elevation", LI_NWC_SCHEMA_UNIT_GROUP_LENGTH);
+   LtInt32 profile_field = properties.AddWideStringField("profile");
+   if (column_properties)
+   {
+      for (int i = 0; i < num_cols; i++)
+      {
+         LtPoint base;
+         columns.GetCenter(i, base);
+
+         LtInt32 row = properties.AddRow();
+         properties.SetDouble(row, height_field, columns.GetHeight(i));
+         properties.SetDouble(row, elevation_field, base[2]);
+         properties.SetWideString(row, profile_field, profile_names[ColumnSpec::m_profile]);
+      }
+   }
+
+   // GUIDs for every column, made in one batch and destroyed after load.
+   // Columns from a binary companion have raw GUIDs and need no parsing.
+   GuidBatch guids;
+   for (int i = 0; i < num_cols; i++)
+   {
+      const LtNat8* raw_guid = columns.GetRawGuid(i);
+      if (raw_guid)
+         guids.AddRawGuid(raw_guid);
+      else
+         guids.AddGuidString(columns.GetGuid(i));
+   }
+
+   // Path styles for 2D outlines, made once per load. Red fill and stroke.
+   static const LtFloat red[4] = { 1, 0, 0, 1 };
+   PlotPathBatcher plot_paths;
+   LtInt32 column_style = plot_paths.AddStyle(red, red);
+
+   // Outlines binned into tiles of at most tile_size columns, or one tile.
+   // Tiles are clipped half a column width outside their outlines, well
+   // clear of the default stroke.
+   PlotTiler tiler(tile_size);
+   tiler.SetClipMargin(1);
+
+   if (batch_2d)
+   {
+      for (int i = 0; i < num_cols; i++)
+      {
+         LtPoint base;
+         columns.GetCenter(i, base);
+         LtPoint2d min = { base[0] - 1, base[1] - 1 };
+         LtPoint2d max = { base[0] + 1, base[1] + 1 };
+         tiler.AddItem(min, max);
+      }
+      tiler.Build();
+
+      // Every outline of a tile in one node, so runs of figures share a
+      // path. Tiles are grouped, each in a canvas clipped to its bounds.
+      LcNwcGroup tiles;
+      tiles.SetName(L"Column Outlines");
+      for (LtInt32 t = 0; t < tiler.GetNumTiles(); t++)
+      {
+         LcNwcGeometry outlines;
+         ColumnPlot plot = { &columns, tiler.GetTileItems(t), tiler.GetNumTileItems(t),
+                             &plot_paths, column_style, (tile_size > 0) ? &tiler : NULL, t };
+         LcNwcPlotStream plot_stream = outlines.OpenPlotStream();
+         geometry(outlines, plot_stream, &plot);
+         outlines.ClosePlotStream(plot_stream);
+
+         outlines.SetClassName(L"Column", "navisworks_mlf_column");
+         if (tile_size > 0)
+         {
+            wchar_t tile_name[32];
+            swprintf(tile_name, 32, L"Tile %d", t + 1);
+            outlines.SetName(tile_name);
+            tiles.AddNode(outlines);
+         }
+         else
+         {
+            outlines.SetName(L"Column Outlines");
+            scene.AddNode(outlines);
+         }
+      }
+      if (tile_size > 0)
+         scene.AddNode(tiles);
+   }
+
+   ColumnBuild build;
+   build.columns = &columns;
+   build.instancer = instance_geometry ? &instancer : NULL;
+   build.progress = &progress;
+
+   if (record_3d)
+   {
+      GeometryPipeline pipeline;
+      if (!pipeline.Run(num_cols, &build_column_cb, &submit_column_cb, &build))
+         return LI_NWC_LOAD_CANCELED;
+   }
 
    // For each of our columns.
-   int num_cols = (int) columns.size();
    for (int i = 0; i < num_cols; i++)
    {
-      ColumnSpec spec = columns.at(i);
+      // Add grid level corresponding to the top of the column.
+      grid.AddLevel(columns.GetHeight(i), L"Top");
+
+      // Batched outlines are already in the scene.
+      if (batch_2d)
+         continue;
 
       // Create geometry for each column.
       LcNwcGeometry geom;
+      LcNwcNode node = geom;
 
-      if (!wcscmp(sheet_id, L"sheet3D"))
+      if (instance_geometry)
+      {
+         node = instancer.CreateNode(build.instances[i]);
+      }
+      else if (record_3d)
+      {
+         node = build.nodes[i];
+      }
+      else if (facet_3d)
       {
-         LcNwcGeometryStream geom_stream = geom.OpenStream();
-         geometry(geom, geom_stream, &spec);
-         geom.CloseStream(geom_stream);
+         ColumnRow spec(columns, i);
+         LcNwcGeometryStream stream = geom.OpenStream();
+         stream.Begin(LI_NWC_VERTEX_NORMAL);
+         brep_faces.BRepEntity(stream, create_col_I(&spec));
+         stream.End();
+         geom.CloseStream(stream);
+
+         if (!progress.Update(LtFloat(i + 1) / num_cols))
+            return LI_NWC_LOAD_CANCELED;
       }
       else if (!wcscmp(sheet_id, L"sheet2D"))
       {
+         LtInt32 item = i;
+         ColumnPlot plot = { &columns, &item, 1, &plot_paths, column_style, NULL, 0 };
          LcNwcPlotStream plot_stream = geom.OpenPlotStream();
-         geometry(geom, plot_stream, &spec);
+         geometry(geom, plot_stream, &plot);
          geom.ClosePlotStream(plot_stream);
       }
       else
          return LI_NWC_LOAD_ERROR;
 
-      // Set GUID.
-      std::wstring guid_wstr = spec.GetGuid();
-      LtNwcGuid guid = LiNwcGuidCreateFromGuidString(guid_wstr.c_str());
-      geom.SetGuid(guid);
+      // Name the column after its position in the file. NWcreate copies
+      // the name, so a stack buffer will do.
+      if (name_columns)
+      {
+         wchar_t column_name[32];
+         swprintf(column_name, 32, L"Column %d", i + 1);
+         node.SetName(column_name);
+         node.SetClassName(L"Column", "navisworks_mlf_column");
+      }
 
-      scene.AddNode(geom);
+      if (column_properties)
+         properties.Attach(node, i);
 
-      // Add grid level corresponding to the top of the column.
-      add_grid_level(system, spec.GetHeight(), L"Top");
+      // Set GUID.
+      node.SetGuid(guids.Get(i));
+
+      scene.AddNode(node);
    }
 
    // Add the complete grid system to the scene.
+   LcNwcGridSystem system(L"MLFGridSystem", origin, x, y);
+   grid.AddTo(system);
    scene.AddGridSystem(system);
 
+   std::wstring statistics = pathname;
+   statistics += L"\n" + f_datasets.GetStatistics();
+   if (column_properties)
+      statistics += L"\n" + properties.GetStatistics();
+   statistics += L"\n" + grid.GetStatistics();
+   if (instance_geometry)
+      statistics += L"\n" + instancer.GetStatistics();
+   if (f_cache_tessellation && record_3d)
+      statistics += L"\n" + f_tessellation_cache.GetStatistics();
+   if (facet_3d)
+   {
+      statistics += L"\n" + brep_faces.GetStatistics();
+      if (f_reuse_brep_profiles)
+         statistics += L"\n" + f_brep_templates.GetStatistics();
+   }
+   if (!wcscmp(sheet_id, L"sheet2D"))
+   {
+      statistics += L"\n" + f_plot_simplifier.GetStatistics();
+      statistics += L"\n" + plot_paths.GetStatistics();
+      if (f_flatten_curves)
+         statistics += L"\n" + f_curve_flattener.GetStatistics();
+      if (batch_2d && tile_size > 0)
+         statistics += L"\n" + tiler.GetStatistics();
+   }
+   scene.SetStatistics(statistics.c_str());
+
    // Extra bits and pieces.
    if (!wcscmp(sheet_id, L"sheet3D"))
    {
@@ -442,6 +789,7 @@ LiNwcLoaderEntry(LtNwcLoader loader_handle)
 {
    LcNwcLoader loader(loader_handle);
 
+   loader.SetUnderstandsFileExCallback(&FileSniffer::UnderstandsFileExCallback, &f_sniffer);
    loader.SetLoadFileInfoCallback(&load_fileinfo_cb, NULL);
    loader.SetLoadFileSheetCallback(&load_file_sheet_cb, NULL);
 